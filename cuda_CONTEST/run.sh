@@ -6,4 +6,8 @@ bin/b -d -c -n 100000000 -b vec -I 2 -i 30 -t 64;
 
 # Run matrix multiplication;
 bin/b -d -c -n 1000 -b mmul -I 1 -i 30 -t 8;
-bin/b -d -c -n 1000 -b mmul -I 2 -i 30 -t 8 -B 14;
\ No newline at end of file
+bin/b -d -c -n 1000 -b mmul -I 2 -i 30 -t 8 -B 14;
+
+# Run Personalized PageRank on the CPU;
+bin/b -d -c -b ppr -I 1 -i 30;
+bin/b -d -c -b ppr -I 2 -i 30 -p 64;
\ No newline at end of file
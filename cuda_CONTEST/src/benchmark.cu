@@ -27,9 +27,16 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-#include "cuda_profiler_api.h"
 #include "benchmark.cuh"
 
+#ifndef CPU_ONLY
+#include "cuda_profiler_api.h"
+#else
+// The host-only build has no profiler to drive;
+inline void cudaProfilerStart() {}
+inline void cudaProfilerStop() {}
+#endif
+
 namespace chrono = std::chrono;
 using clock_type = chrono::high_resolution_clock;
 
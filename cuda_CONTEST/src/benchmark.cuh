@@ -56,7 +56,9 @@ struct Benchmark {
                                   benchmark_name(options.benchmark_choice),
                                   do_cpu_validation(options.do_cpu_validation),
                                   nvprof(options.nvprof) {
+#ifndef CPU_ONLY
         cudaDeviceGetAttribute(&pascalGpu, cudaDeviceAttr::cudaDevAttrConcurrentManagedAccess, 0);
+#endif
         if (debug) {
             std::cout << "------------------------------" << std::endl;
             std::cout << "- running " << options.benchmark_map[benchmark_name] << std::endl;
@@ -29,6 +29,9 @@
 
 #include <sstream>
 #include "personalized_pagerank.cuh"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace chrono = std::chrono;
 using clock_type = chrono::high_resolution_clock;
@@ -95,6 +98,34 @@ void PersonalizedPageRank::alloc() {
     // Load the input graph and preprocess it;
     initialize_graph();
 
+    // Convert the graph to CSR, with a counting sort by row that keeps the order of the edges in each row;
+    csr_offsets.assign(V + 1, 0);
+    for (int i = 0; i < E; i++) {
+        csr_offsets[x[i] + 1]++;
+    }
+    for (int i = 0; i < V; i++) {
+        csr_offsets[i + 1] += csr_offsets[i];
+    }
+    csr_columns.resize(E);
+    csr_values.resize(E);
+    std::vector<int> cursor(csr_offsets.begin(), csr_offsets.end() - 1);
+    for (int i = 0; i < E; i++) {
+        int position = cursor[x[i]]++;
+        csr_columns[position] = y[i];
+        csr_values[position] = val[i];
+    }
+    pr_tmp.resize(V);
+    if (implementation == 2) {
+        personalization_vertices.resize(batch_size);
+        pr_batch.resize((size_t) V * batch_size);
+        pr_block.resize((size_t) V * batch_size);
+        pr_block_tmp.resize((size_t) V * batch_size);
+        if (debug) std::cout << "PPR batch size=" << batch_size << std::endl;
+    }
+#ifdef _OPENMP
+    if (debug) std::cout << "CPU threads=" << omp_get_max_threads() << std::endl;
+#endif
+
     // Allocate any GPU data here;
     // TODO!
 }
@@ -113,17 +144,245 @@ void PersonalizedPageRank::reset() {
    // Generate a new personalization vertex for this iteration;
    personalization_vertex = rand() % V; 
    if (debug) std::cout << "personalization vertex=" << personalization_vertex << std::endl;
+   // In the batched implementation, the first vertex of the batch is the one above;
+   if (implementation == 2) {
+       personalization_vertices[0] = personalization_vertex;
+       for (int j = 1; j < batch_size; j++) {
+           personalization_vertices[j] = rand() % V;
+       }
+       std::fill(pr_batch.begin(), pr_batch.end(), 1.0 / V);
+   }
 
    // Do any GPU reset here, and also transfer data to the GPU;
    // TODO!
 }
 
-void PersonalizedPageRank::execute(int iter) {
+// GPU implementation;
+void PersonalizedPageRank::personalized_pagerank_0(int iter) {
     // Do the GPU computation here, and also transfer results to the CPU;
     //TODO! (and save the GPU PPR values into the "pr" array)
 }
 
+// Multithreaded CPU implementation, on the CSR graph (with OpenMP; sequential if built without it).
+// Each iteration is a single parallel pass over the rows: every vertex pulls the values of its in-neighbors (SpMV),
+// then computes its new value, and the same pass accumulates the convergence norm and the dangling factor
+// of the next iteration. Instead of copying, pr and pr_tmp are swapped at the end of the iteration;
+void PersonalizedPageRank::personalized_pagerank_1(int iter) {
+    const int *offsets = csr_offsets.data();
+    const int *columns = csr_columns.data();
+    const double *values = csr_values.data();
+    const int *dangling_bitmap = dangling.data();
+    const int V = this->V;
+    const int personalization_vertex = this->personalization_vertex;
+    const double alpha = this->alpha;
+
+    double dangling_factor = 0;
+    const double *pr_in = pr.data();
+    #pragma omp parallel for reduction(+: dangling_factor)
+    for (int i = 0; i < V; i++) {
+        dangling_factor += dangling_bitmap[i] * pr_in[i];
+    }
+
+    int iterations = 0;
+    double err = 0;
+    bool converged = false;
+    while (!converged && iterations < max_iterations) {
+        const double *pr_old = pr.data();
+        double *pr_new = pr_tmp.data();
+        const double beta = alpha * dangling_factor / V;
+        double squared_err = 0;
+        double next_dangling_factor = 0;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+: squared_err, next_dangling_factor)
+        for (int i = 0; i < V; i++) {
+            double sum = 0;
+            for (int k = offsets[i]; k < offsets[i + 1]; k++) {
+                sum += values[k] * pr_old[columns[k]];
+            }
+            double value = alpha * sum + beta + ((personalization_vertex == i) ? 1 - alpha : 0.0);
+            double diff = value - pr_old[i];
+            squared_err += diff * diff;
+            next_dangling_factor += dangling_bitmap[i] * value;
+            pr_new[i] = value;
+        }
+        pr.swap(pr_tmp);
+        dangling_factor = next_dangling_factor;
+        err = std::sqrt(squared_err);
+        converged = err <= convergence_threshold;
+        iterations++;
+    }
+    if (debug) std::cout << "  CPU iterations=" << iterations << ", error=" << err << std::endl;
+}
+
+// Batched multithreaded CPU implementation: PPR for batch_size personalization vertices at once, on a V x w
+// row-major block holding the w columns that have not converged yet. Each iteration is a single pass over the rows
+// as in personalized_pagerank_1, but every edge updates the w values of its row (SpMM instead of SpMV), so the graph
+// is read once per iteration for the whole batch. Convergence is checked column by column: converged columns are
+// written to pr_batch and removed from the block, so that the next iterations only work on the remaining ones;
+void PersonalizedPageRank::personalized_pagerank_2(int iter) {
+    const int *offsets = csr_offsets.data();
+    const int *columns = csr_columns.data();
+    const double *values = csr_values.data();
+    const int *dangling_bitmap = dangling.data();
+    const int V = this->V;
+    const int B = batch_size;
+    const double alpha = this->alpha;
+
+    // Column of the batch held by each slot of the block, and its personalization vertex;
+    int w = B;
+    std::vector<int> slot_column(B);
+    std::vector<int> slot_vertex(B);
+    std::vector<char> is_personalization(V, 0);
+    for (int j = 0; j < B; j++) {
+        slot_column[j] = j;
+        slot_vertex[j] = personalization_vertices[j];
+        is_personalization[slot_vertex[j]] = 1;
+    }
+    std::vector<double> beta(B), dangling_factor(B, 0), squared_err(B), next_dangling_factor(B);
+    std::vector<int> kept(B);
+    double *dangling_sum = dangling_factor.data();
+    double *err_sum = squared_err.data();
+    double *next_dangling_sum = next_dangling_factor.data();
+
+    std::copy(pr_batch.begin(), pr_batch.end(), pr_block.begin());
+    const double *block_in = pr_block.data();
+    #pragma omp parallel for reduction(+: dangling_sum[:B])
+    for (int i = 0; i < V; i++) {
+        if (dangling_bitmap[i]) {
+            for (int j = 0; j < B; j++) {
+                dangling_sum[j] += block_in[(size_t) i * B + j];
+            }
+        }
+    }
+
+    int iterations = 0;
+    while (w > 0 && iterations < max_iterations) {
+        const double *pr_old = pr_block.data();
+        double *pr_new = pr_block_tmp.data();
+        for (int j = 0; j < w; j++) {
+            beta[j] = alpha * dangling_factor[j] / V;
+            squared_err[j] = 0;
+            next_dangling_factor[j] = 0;
+        }
+        const double *beta_in = beta.data();
+        const int *vertex_in = slot_vertex.data();
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+: err_sum[:w], next_dangling_sum[:w])
+        for (int i = 0; i < V; i++) {
+            double *row = pr_new + (size_t) i * w;
+            for (int j = 0; j < w; j++) {
+                row[j] = 0;
+            }
+            for (int k = offsets[i]; k < offsets[i + 1]; k++) {
+                const double value = values[k];
+                const double *neighbor = pr_old + (size_t) columns[k] * w;
+                for (int j = 0; j < w; j++) {
+                    row[j] += value * neighbor[j];
+                }
+            }
+            for (int j = 0; j < w; j++) {
+                row[j] = alpha * row[j] + beta_in[j];
+            }
+            if (is_personalization[i]) {
+                for (int j = 0; j < w; j++) {
+                    if (vertex_in[j] == i) row[j] += 1 - alpha;
+                }
+            }
+            const double *old_row = pr_old + (size_t) i * w;
+            for (int j = 0; j < w; j++) {
+                double diff = row[j] - old_row[j];
+                err_sum[j] += diff * diff;
+            }
+            if (dangling_bitmap[i]) {
+                for (int j = 0; j < w; j++) {
+                    next_dangling_sum[j] += row[j];
+                }
+            }
+        }
+        pr_block.swap(pr_block_tmp);
+        iterations++;
+
+        // Keep the columns that have not converged, unless this was the last iteration;
+        int num_kept = 0;
+        for (int j = 0; j < w; j++) {
+            if (iterations < max_iterations && std::sqrt(squared_err[j]) > convergence_threshold) {
+                kept[num_kept++] = j;
+            }
+        }
+        if (num_kept == w) {
+            std::copy(next_dangling_factor.begin(), next_dangling_factor.begin() + w, dangling_factor.begin());
+            continue;
+        }
+        // Write the converged columns to the batch, and compact the others into the new block;
+        const double *block = pr_block.data();
+        double *compacted = pr_block_tmp.data();
+        double *batch = pr_batch.data();
+        const int *column_in = slot_column.data();
+        const int *kept_in = kept.data();
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < V; i++) {
+            const double *row = block + (size_t) i * w;
+            for (int j = 0, k = 0; j < w; j++) {
+                if (k < num_kept && kept_in[k] == j) {
+                    compacted[(size_t) i * num_kept + k++] = row[j];
+                } else {
+                    batch[(size_t) i * B + column_in[j]] = row[j];
+                }
+            }
+        }
+        pr_block.swap(pr_block_tmp);
+        for (int k = 0; k < num_kept; k++) {
+            slot_column[k] = slot_column[kept[k]];
+            slot_vertex[k] = slot_vertex[kept[k]];
+            dangling_factor[k] = next_dangling_factor[kept[k]];
+        }
+        w = num_kept;
+        if (debug) std::cout << "  CPU iteration=" << iterations << ", active vectors=" << w << std::endl;
+    }
+    if (debug) std::cout << "  CPU iterations=" << iterations << ", vectors=" << B << std::endl;
+
+    // Keep the vector of the first personalization vertex in pr;
+    for (int i = 0; i < V; i++) {
+        pr[i] = pr_batch[(size_t) i * B];
+    }
+}
+
+void PersonalizedPageRank::execute(int iter) {
+    switch (implementation)
+    {
+    case 0:
+        personalized_pagerank_0(iter);
+        break;
+    case 1:
+        personalized_pagerank_1(iter);
+        break;
+    case 2:
+        personalized_pagerank_2(iter);
+        break;
+    default:
+        break;
+    }
+}
+
 void PersonalizedPageRank::cpu_validation(int iter) {
+    if (implementation != 2) {
+        precision = validate(personalization_vertex);
+        return;
+    }
+    // Check every vector of the batch, then restore the first one in pr;
+    double total_precision = 0;
+    for (int j = 0; j < batch_size; j++) {
+        for (int i = 0; i < V; i++) {
+            pr[i] = pr_batch[(size_t) i * batch_size + j];
+        }
+        total_precision += validate(personalization_vertices[j]);
+    }
+    for (int i = 0; i < V; i++) {
+        pr[i] = pr_batch[(size_t) i * batch_size];
+    }
+    precision = total_precision / batch_size;
+    if (debug) std::cout << "mean precision over " << batch_size << " vectors=" << 100 * precision << "%" << std::endl;
+}
+
+double PersonalizedPageRank::validate(int personalization_vertex) {
 
     // Reset the CPU PageRank vector (uniform initialization, 1 / V for each vertex);
     std::fill(pr_golden.begin(), pr_golden.end(), 1.0 / V);
@@ -164,8 +423,9 @@ void PersonalizedPageRank::cpu_validation(int iter) {
     // Set intersection to find correctly retrieved vertices;
     std::vector<int> correctly_retrieved_vertices;
     set_intersection(top_pr_indices.begin(), top_pr_indices.end(), top_pr_golden_indices.begin(), top_pr_golden_indices.end(), std::back_inserter(correctly_retrieved_vertices));
-    precision = double(correctly_retrieved_vertices.size()) / topk;
+    double precision = double(correctly_retrieved_vertices.size()) / topk;
     if (debug) std::cout << "correctly retrived top-" << topk << " vertices=" << correctly_retrieved_vertices.size() << " (" << 100 * precision << "%)" << std::endl;
+    return precision;
 }
 
 std::string PersonalizedPageRank::print_result(bool short_form) {
@@ -28,6 +28,8 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
+#include <cmath>
+#include <cstring>
 #include <set>
 #include <iterator>
 #include "../benchmark.cuh"
@@ -122,6 +124,7 @@ class PersonalizedPageRank : public Benchmark {
         max_iterations = options.maximum_iterations;
         convergence_threshold = options.convergence_threshold;
         graph_file_path = options.graph;
+        batch_size = std::max(1, options.ppr_batch);
     }
     void alloc();
     void init();
@@ -140,6 +143,19 @@ class PersonalizedPageRank : public Benchmark {
     std::vector<int> dangling;
     std::vector<double> pr;   // Store here the PageRank values computed by the GPU;
     std::vector<double> pr_golden;  // PageRank values computed by the CPU;
+    // CSR version of the (transposed) graph, sorted by row: the in-edges of vertex i are
+    // csr_columns[csr_offsets[i]..csr_offsets[i + 1]), with values csr_values;
+    std::vector<int> csr_offsets;
+    std::vector<int> csr_columns;
+    std::vector<double> csr_values;
+    std::vector<double> pr_tmp;     // Next PageRank values, swapped with pr after every iteration;
+    // Batched PPR: one PageRank vector for each of batch_size personalization vertices, stored as a
+    // V x batch_size row-major block (the values of vertex i for the whole batch are contiguous);
+    int batch_size = DEFAULT_PPR_BATCH;
+    std::vector<int> personalization_vertices;
+    std::vector<double> pr_batch;   // Final values of the batch;
+    std::vector<double> pr_block;   // Values of the columns that have not converged yet, and their next values;
+    std::vector<double> pr_block_tmp;
     int personalization_vertex = 0;
     double convergence_threshold = DEFAULT_CONVERGENCE;
     double alpha = DEFAULT_ALPHA;
@@ -149,4 +165,11 @@ class PersonalizedPageRank : public Benchmark {
     std::string graph_file_path = DEFAULT_GRAPH;
 
     void initialize_graph();
+    // Compare the values in pr with the CPU PPR of the given vertex, and return the top-k precision;
+    double validate(int personalization_vertex);
+
+    // Implementations of the algorithm;
+    void personalized_pagerank_0(int iter);
+    void personalized_pagerank_1(int iter);
+    void personalized_pagerank_2(int iter);
 };
\ No newline at end of file
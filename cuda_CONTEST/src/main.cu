@@ -34,8 +34,10 @@
 #include "options.hpp"
 #include "benchmark.cuh"
 
+#ifndef CPU_ONLY
 #include "benchmarks/vector_sum.cuh"
 #include "benchmarks/matrix_multiplication.cuh"
+#endif
 #include "benchmarks/personalized_pagerank.cuh"
 
 int main(int argc, char *argv[])
@@ -45,16 +47,18 @@ int main(int argc, char *argv[])
     
     Options options = Options(argc, argv);
     BenchmarkEnum benchmark_choice = options.benchmark_choice;
-    Benchmark *b;
+    Benchmark *b = nullptr;
 
     switch (benchmark_choice)
     {
+#ifndef CPU_ONLY
     case BenchmarkEnum::VEC:
         b = new VectorSum(options);
         break;
     case BenchmarkEnum::MMUL:
         b = new MatrixMultiplication(options);
         break;
+#endif
     case BenchmarkEnum::PPR:
         b = new PersonalizedPageRank(options);
         break;
@@ -56,6 +56,7 @@
 #define DEFAULT_ALPHA 0.85
 #define DEFAULT_MAX_ITER 30
 #define DEFAULT_CONVERGENCE 1e-6
+#define DEFAULT_PPR_BATCH 64
 
 //////////////////////////////
 //////////////////////////////
@@ -97,6 +98,7 @@ struct Options {
     double alpha = DEFAULT_ALPHA;
     int maximum_iterations = DEFAULT_MAX_ITER;
     double convergence_threshold = DEFAULT_CONVERGENCE;
+    int ppr_batch = DEFAULT_PPR_BATCH;
 
     // Used for printing;
     std::map<BenchmarkEnum, std::string> benchmark_map;
@@ -125,11 +127,12 @@ struct Options {
                                                {"alpha", required_argument, 0, 'a'},
                                                {"max_iterations", required_argument, 0, 'm'},
                                                {"convergence_threshold", required_argument, 0, 'e'},
+                                               {"ppr_batch", required_argument, 0, 'p'},
                                                {0, 0, 0, 0}};
         // getopt_long stores the option index here;
         int option_index = 0;
 
-        while ((opt = getopt_long(argc, argv, "di:n:t:B:s:b:vI:cg:a:m:e:", long_options, &option_index)) != EOF) {
+        while ((opt = getopt_long(argc, argv, "di:n:t:B:s:b:vI:cg:a:m:e:p:", long_options, &option_index)) != EOF) {
             switch (opt) {
                 case 'd':
                     debug = true;
@@ -173,6 +176,9 @@ struct Options {
                 case 'e':
                     convergence_threshold = atof(optarg);
                     break;
+                case 'p':
+                    ppr_batch = atoi(optarg);
+                    break;
                 default:
                     break;
             }
@@ -0,0 +1,3 @@
+1 2 1
+2 10 1
+10 1 1
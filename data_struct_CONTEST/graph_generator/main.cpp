@@ -5,8 +5,9 @@
 #include <vector>
 //#include <set>
 //#include <chrono>
-//#include <algorithm>
+#include <algorithm>
 #include <functional>
+#include <cmath>
 //#include <unistd.h>
 
 
@@ -14,6 +15,34 @@ bool dens(float d) {
     return rand()%100 < d; 
 }
 
+// sample a vertex with probability proportional to its weight,
+// given the cumulative weights of all the vertices
+uint64_t sample_vertex(const std::vector<double>& cumulative) {
+    double r = (double)rand() / ((double)RAND_MAX + 1) * cumulative.back();
+    return std::upper_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin();
+}
+
+// power-law (Chung-Lu) graph: endpoints are drawn with probability
+// proportional to (i+1)^(-1/(gamma-1)), so degrees follow a power law of exponent gamma.
+// Every vertex gets at least one out-edge, so that vertex ids stay dense
+void generate_power_law(std::vector<std::tuple<uint64_t, uint64_t, double> >& edges, uint64_t num_nodes, uint64_t num_edges, bool undirected, double gamma = 2.1) {
+    std::vector<double> cumulative(num_nodes);
+    double total = 0;
+    for(uint64_t i = 0; i < num_nodes; i++){
+        total += std::pow((double)(i + 1), -1.0 / (gamma - 1));
+        cumulative[i] = total;
+    }
+    for(uint64_t k = 0; k < std::max(num_edges, num_nodes); k++){
+        uint64_t i = (k < num_nodes) ? k : sample_vertex(cumulative);
+        uint64_t j = sample_vertex(cumulative);
+        // no self-loop allowed
+        if(i == j) j = (j + 1) % num_nodes;
+        // each undirected edge is stored once, the loader adds the reverse one
+        if(undirected && i > j) std::swap(i, j);
+        edges.push_back(std::make_tuple(i, j, (double)(rand()%100)/100.0));
+    }
+}
+
 void write_edge_list(std::vector<std::tuple<uint64_t, uint64_t, double> > edges, uint64_t e, std::string filename){
     std::ofstream outfile(filename+".e");
     for(uint64_t j = 0; j < e; j++)
@@ -32,7 +61,8 @@ int main(int argc, char **argv) {
     // argv[1] -> number of nodes
     // argv[2] -> graph density (%)
     // argv[3] -> seed for PRNG
-    // argv[4] -> -U (if undirected graph, default: directed graph)
+    // argv[4+] -> -U (if undirected graph, default: directed graph)
+    // argv[4+] -> -P (power-law degree distribution, default: uniform)
 
     uint64_t num_nodes = std::stoi(argv[1]);
     float density = std::stof(argv[2]);
@@ -40,26 +70,34 @@ int main(int argc, char **argv) {
     srand(seed);
 
     // default: directed graph
+    // default: uniform degree distribution
     bool undirected = false;
-    if (argc > 4){
-        undirected = (std::string(argv[4]) == "-U") ? true : false; 
+    bool power_law = false;
+    for (int arg = 4; arg < argc; arg++){
+        if (std::string(argv[arg]) == "-U") undirected = true;
+        if (std::string(argv[arg]) == "-P") power_law = true;
     }
 
     std::vector< std::tuple<uint64_t, uint64_t, double> > edges;
     std::tuple<uint64_t, uint64_t, double> edge_tmp;
 
-    for(uint64_t i = 0; i < num_nodes; i++){
-        for(uint64_t j = 0; j < num_nodes; j++){
-            if(dens(density)){
-                edge_tmp = std::make_tuple(i, j, (double)(rand()%100)/100.0);
-                edges.push_back(edge_tmp);
-            }
-        } 
+    if(power_law){
+        // same expected number of edges of the uniform graph with this density
+        generate_power_law(edges, num_nodes, (uint64_t)(num_nodes * num_nodes * density / 100), undirected);
+    } else {
+        for(uint64_t i = 0; i < num_nodes; i++){
+            for(uint64_t j = 0; j < num_nodes; j++){
+                if(dens(density)){
+                    edge_tmp = std::make_tuple(i, j, (double)(rand()%100)/100.0);
+                    edges.push_back(edge_tmp);
+                }
+            } 
+        }
     }
 
     std::cout << "Num of edges = " << edges.size() << std::endl;
     std::stringstream filename;
-    filename << "../data/N" << num_nodes << "_D" << density << "_S" << seed;
+    filename << "../data/" << (power_law ? "PL" : "N") << num_nodes << "_D" << density << "_S" << seed << (undirected ? "_U" : "");
 
     write_edge_list(edges, edges.size(), filename.str());
     write_node_set(num_nodes, filename.str());
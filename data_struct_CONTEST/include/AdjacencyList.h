@@ -1,9 +1,13 @@
 #ifndef ORACLE_CONTEST_ADJACENCYLIST_H
 #define ORACLE_CONTEST_ADJACENCYLIST_H
 
+#include <cstdint>
 #include <list>
 #include <vector>
 #include <functional>
+#include "EdgeList.h"
+#include "LocalityProfiler.h"
+#include "ReverseIndex.h"
 
 // Adjacency list implementation of Graph
 class AdjacencyList{
@@ -48,6 +52,7 @@ class AdjacencyList{
     uint64_t v, e;
     std::list<uint64_t>* edges;
     std::list<double>* weights;
+    ReverseIndex<uint64_t> in_edges;
 
 public:
 
@@ -55,6 +60,71 @@ public:
         return EdgeIter(begin(idx), end(idx), begin_weights(idx));
     }
 
+    // call f(neighbor, weight) for every neighbor of idx, without building pairs
+    template<typename F>
+    inline void for_each_neighbor(uint64_t idx, F f) const {
+        std::list<double>::const_iterator w = weights[idx].begin();
+        for (std::list<uint64_t>::const_iterator it = edges[idx].begin(); it != edges[idx].end(); ++it, ++w) {
+            LOCALITY_ACCESS(ADJACENCY, &*it);
+            LOCALITY_ACCESS(WEIGHTS, &*w);
+            f(*it, *w);
+        }
+    }
+
+    // position in the neighbors of a vertex, for visits that stop and resume (e.g. DFS)
+    class NeighborCursor {
+        std::list<uint64_t>::const_iterator it, end;
+        std::list<double>::const_iterator w;
+
+    public:
+        NeighborCursor(const std::list<uint64_t> &ids, const std::list<double> &weights) : it(ids.begin()), end(ids.end()), w(weights.begin()) {}
+
+        // next neighbor in list order; false after the last one
+        inline bool next(uint64_t &to, double &weight) {
+            if (it == end)
+                return false;
+            LOCALITY_ACCESS(ADJACENCY, &*it);
+            LOCALITY_ACCESS(WEIGHTS, &*w);
+            to = *it++;
+            weight = *w++;
+            return true;
+        }
+    };
+
+    NeighborCursor cursor(uint64_t idx) const {
+        return NeighborCursor(edges[idx], weights[idx]);
+    }
+
+    // in-neighbors of idx; the transpose is built on first use
+    ReverseIndex<uint64_t>::EdgeIter get_in_neighbors(uint64_t idx){
+        in_edges.ensure(*this, v + 2);
+        return in_edges.get_neighbors(idx);
+    }
+
+    template<typename F>
+    inline void for_each_in_neighbor(uint64_t idx, F f){
+        in_edges.ensure(*this, v + 2);
+        in_edges.for_each_neighbor(idx, f);
+    }
+
+    inline uint64_t in_degree(uint64_t idx){
+        in_edges.ensure(*this, v + 2);
+        return in_edges.degree(idx);
+    }
+
+    inline uint64_t degree(uint64_t idx) const { return edges[idx].size(); }
+
+    // memory used by the data structure (estimated, two list nodes per edge),
+    // including the transpose if built
+    uint64_t size_in_bytes() const {
+        uint64_t list_nodes = 0;
+        for(uint64_t i = 0; i < v + 2; ++i)
+            list_nodes += edges[i].size() + weights[i].size();
+        return (v + 2) * 2 * sizeof(std::list<uint64_t>) + list_nodes * (2 * sizeof(void*) + sizeof(uint64_t)) + in_edges.size_in_bytes();
+    }
+
+    uint64_t reverse_index_size_in_bytes() const { return in_edges.size_in_bytes(); }
+
     AdjacencyList(uint64_t v, uint64_t e) : v(v), e(e){
         edges = new std::list<uint64_t>[v + 2];
         weights = new std::list<double>[v + 2];
@@ -80,6 +150,8 @@ public:
 
     void populate(std::tuple<uint64_t, uint64_t, double>* e_list);
 
+    void populate(const EdgeList &edges);
+
     inline std::list<uint64_t>::iterator begin(int cur_vertex) {
         return edges[cur_vertex].begin();
     }
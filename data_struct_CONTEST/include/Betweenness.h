@@ -0,0 +1,124 @@
+#ifndef ORACLE_CONTEST_BETWEENNESS_H
+#define ORACLE_CONTEST_BETWEENNESS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "ThreadPool.h"
+
+// Betweenness centrality with Brandes' algorithm on unweighted (hop) shortest paths: for every
+// source s, a bfs counts the shortest paths sigma[v] from s to every vertex, then the vertices are
+// visited in reverse bfs order accumulating the dependency of s on v,
+//   delta[v] = sum over out-neighbors w of v one level below: sigma[v] / sigma[w] * (1 + delta[w]),
+// which is added to the score of v. Works on any graph type with for_each_neighbor.
+//
+// Every source is a task of the ThreadPool, so that work stealing balances sources whose
+// components differ in size (on skewed graphs, the sources of the giant component). Each worker
+// has its own bfs arrays and score array, allocated at its first source; the score arrays are
+// summed at the end, in worker order (with several threads, which worker gets which source depends
+// on scheduling, so the scores may differ in the last digits between runs). Every bfs only clears
+// the vertices it reached, so a source costs the size of its component.
+//
+// With a sample of k sources out of the n vertices, the scores scaled by n / k are an unbiased
+// estimate of the exact ones (Brandes and Pich); see betweenness_error for the error bound.
+// Sources are vertex ids, in [0, n): n is the number of ids, not of the vertex slots of the graph.
+
+// bc[v] = scale * sum over the sources s of the dependency of s on v, for v in [0, n), where n
+// is the number of vertex slots of the graph
+template<typename G>
+void betweenness_centrality(G &graph, uint64_t n, const std::vector<uint64_t> &sources, double scale, double *bc) {
+    ThreadPool &pool = ThreadPool::instance();
+    struct WorkerState {
+        std::vector<uint64_t> dist, order;
+        std::vector<double> sigma, delta, score;
+    };
+    std::vector<WorkerState> states(pool.size());
+
+    pool.parallel_for(0, sources.size(), [&](uint64_t i) {
+        const uint64_t s = sources[i];
+        if (s >= n)
+            return;
+        WorkerState &state = states[pool.current_worker()];
+        if (state.score.empty()) {
+            state.dist.assign(n, UINT64_MAX);
+            state.sigma.assign(n, 0);
+            state.delta.assign(n, 0);
+            state.score.assign(n, 0);
+            state.order.reserve(n);
+        }
+        std::vector<uint64_t> &dist = state.dist, &order = state.order;
+        std::vector<double> &sigma = state.sigma, &delta = state.delta, &score = state.score;
+        // bfs counting the shortest paths; order doubles as the queue
+        order.clear();
+        order.push_back(s);
+        dist[s] = 0;
+        sigma[s] = 1;
+        for (uint64_t head = 0; head < order.size(); head++) {
+            const uint64_t x = order[head], next_dist = dist[x] + 1;
+            graph.for_each_neighbor(x, [&](uint64_t to, double) {
+                if (dist[to] == UINT64_MAX) {
+                    dist[to] = next_dist;
+                    order.push_back(to);
+                }
+                if (dist[to] == next_dist)
+                    sigma[to] += sigma[x];
+            });
+        }
+        // dependencies, from the deepest level up
+        for (uint64_t k = order.size(); k-- > 0;) {
+            const uint64_t x = order[k], next_dist = dist[x] + 1;
+            double d = 0;
+            graph.for_each_neighbor(x, [&](uint64_t to, double) {
+                if (dist[to] == next_dist)
+                    d += (1 + delta[to]) / sigma[to];
+            });
+            delta[x] = sigma[x] * d;
+            if (x != s)
+                score[x] += delta[x];
+        }
+        for (uint64_t x : order) {
+            dist[x] = UINT64_MAX;
+            sigma[x] = delta[x] = 0;
+        }
+    }, 1);
+
+    pool.parallel_for(0, n, [&](uint64_t x) {
+        double sum = 0;
+        for (const WorkerState &state : states)
+            if (!state.score.empty())
+                sum += state.score[x];
+        bc[x] = scale * sum;
+    });
+}
+
+// k distinct sources drawn uniformly from [0, n) (all of them if k >= n), sorted
+inline std::vector<uint64_t> sample_sources(uint64_t n, uint64_t k, uint64_t seed) {
+    std::vector<uint64_t> ids(n);
+    for (uint64_t i = 0; i < n; i++)
+        ids[i] = i;
+    if (k < n) {
+        // partial Fisher-Yates shuffle
+        std::mt19937_64 rng(seed);
+        for (uint64_t i = 0; i < k; i++)
+            std::swap(ids[i], ids[i + std::uniform_int_distribution<uint64_t>(0, n - 1 - i)(rng)]);
+        ids.resize(k);
+        std::sort(ids.begin(), ids.end());
+    }
+    return ids;
+}
+
+// error bound of the estimate of a vertex from k uniform sources out of n, for the normalised
+// score (divided by n (n - 1), the number of ordered pairs): the normalised estimate is the mean
+// over the sources of the dependency on the vertex divided by n - 1, which is in [0, 1], so by
+// Hoeffding's inequality (which also holds sampling without replacement), with probability
+// confidence it is within the returned bound of the exact normalised score. The bound holds for
+// each vertex, not for all of them at once. 0 if k >= n (exact scores)
+inline double betweenness_error(uint64_t n, uint64_t k, double confidence) {
+    if (k >= n || k == 0 || n < 2)
+        return 0;
+    return std::sqrt(std::log(2.0 / (1 - confidence)) / (2.0 * k));
+}
+
+#endif //ORACLE_CONTEST_BETWEENNESS_H
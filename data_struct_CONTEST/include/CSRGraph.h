@@ -0,0 +1,174 @@
+#ifndef ORACLE_CONTEST_CSRGRAPH_H
+#define ORACLE_CONTEST_CSRGRAPH_H
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include "EdgeList.h"
+#include "LocalityProfiler.h"
+#include "NeighborSpan.h"
+#include "ReverseIndex.h"
+
+// Compressed Sparse Row implementation of Graph:
+// neighbors of vertex i are ids[offsets[i]..offsets[i+1]), with 32-bit ids and float weights
+// (the loader parses weights as float, so no precision is lost).
+// Weights are not stored for unweighted graphs, where every edge weighs 1
+class CSRGraph{
+
+    class EdgeIter {
+    public:
+        class iterator {
+        public:
+            iterator(const uint32_t *ptr, const float *w_ptr) : ptr(ptr), w_ptr(w_ptr) {}
+
+            iterator operator++() {
+                ++ptr;
+                if (w_ptr)
+                    ++w_ptr;
+                return *this;
+            }
+
+            bool operator!=(const iterator &other) { return ptr != other.ptr; }
+
+            const std::pair<uint64_t, double> &operator*() {
+                current.first = *ptr;
+                current.second = w_ptr ? *w_ptr : 1.0;
+                return current;
+            };
+
+        private:
+            const uint32_t *ptr;
+            const float *w_ptr;
+            std::pair<uint64_t, double> current;
+        };
+
+    private:
+        const uint32_t *begin_ptr, *end_ptr;
+        const float *begin_w_ptr;
+    public:
+        EdgeIter(const uint32_t *begin_ptr, const uint32_t *end_ptr, const float *begin_w_ptr) : begin_ptr(begin_ptr), end_ptr(end_ptr), begin_w_ptr(begin_w_ptr) {}
+
+        iterator begin() const { return iterator(begin_ptr, begin_w_ptr); }
+
+        iterator end() const { return iterator(end_ptr, begin_w_ptr); }
+    };
+
+    uint64_t v, e;
+    uint64_t *offsets;
+    uint32_t *ids;
+    float *weights;         // nullptr if the graph is unweighted
+    ReverseIndex<uint32_t> in_edges;
+
+    template<typename Edges>
+    void build(const Edges &edges, bool weighted);
+
+public:
+
+    CSRGraph(uint64_t v, uint64_t e) : v(v), e(e), offsets(nullptr), ids(nullptr), weights(nullptr) {}
+
+    ~CSRGraph(){
+        delete[] offsets;
+        delete[] ids;
+        delete[] weights;
+    }
+
+    EdgeIter get_neighbors(uint64_t idx){
+        return EdgeIter(ids + offsets[idx], ids + offsets[idx + 1], weights ? weights + offsets[idx] : nullptr);
+    }
+
+    // zero-copy view of the neighbors of idx (empty weights if unweighted)
+    NeighborSpan<uint32_t> neighbors(uint64_t idx) const {
+        return NeighborSpan<uint32_t>(Span<uint32_t>(ids + offsets[idx], ids + offsets[idx + 1]),
+            weights ? Span<float>(weights + offsets[idx], weights + offsets[idx + 1]) : Span<float>());
+    }
+
+    // position in the neighbors of a vertex, for visits that stop and resume (e.g. DFS)
+    class NeighborCursor {
+        const uint32_t *ids;
+        const float *weights;
+        uint64_t i, end;
+
+    public:
+        NeighborCursor(const uint32_t *ids, const float *weights, uint64_t begin, uint64_t end) : ids(ids), weights(weights), i(begin), end(end) {}
+
+        // next neighbor in storage order; false after the last one
+        inline bool next(uint64_t &to, double &weight) {
+            if (i == end)
+                return false;
+            LOCALITY_ACCESS(ADJACENCY, &ids[i]);
+            to = ids[i];
+            if (weights) {
+                LOCALITY_ACCESS(WEIGHTS, &weights[i]);
+                weight = weights[i];
+            } else {
+                weight = 1.0;
+            }
+            i++;
+            return true;
+        }
+    };
+
+    NeighborCursor cursor(uint64_t idx) const {
+        LOCALITY_ACCESS(ADJACENCY, &offsets[idx]);
+        return NeighborCursor(ids, weights, offsets[idx], offsets[idx + 1]);
+    }
+
+    // call f(neighbor, weight) for every neighbor of idx, in storage order
+    template<typename F>
+    inline void for_each_neighbor(uint64_t idx, F f) const {
+        LOCALITY_ACCESS(ADJACENCY, &offsets[idx]);
+        const uint64_t begin = offsets[idx], end = offsets[idx + 1];
+        if (weights) {
+            for (uint64_t i = begin; i < end; i++) {
+                LOCALITY_ACCESS(ADJACENCY, &ids[i]);
+                LOCALITY_ACCESS(WEIGHTS, &weights[i]);
+                f((uint64_t)ids[i], (double)weights[i]);
+            }
+        } else {
+            for (uint64_t i = begin; i < end; i++) {
+                LOCALITY_ACCESS(ADJACENCY, &ids[i]);
+                f((uint64_t)ids[i], 1.0);
+            }
+        }
+    }
+
+    inline bool is_weighted() const { return weights != nullptr; }
+
+    inline uint64_t degree(uint64_t idx) const { return offsets[idx + 1] - offsets[idx]; }
+
+    // in-neighbors of idx; the transpose is built on first use
+    ReverseIndex<uint32_t>::EdgeIter get_in_neighbors(uint64_t idx){
+        in_edges.ensure(*this, v + 2);
+        return in_edges.get_neighbors(idx);
+    }
+
+    template<typename F>
+    inline void for_each_in_neighbor(uint64_t idx, F f){
+        in_edges.ensure(*this, v + 2);
+        in_edges.for_each_neighbor(idx, f);
+    }
+
+    inline uint64_t in_degree(uint64_t idx){
+        in_edges.ensure(*this, v + 2);
+        return in_edges.degree(idx);
+    }
+
+    // memory used by the data structure, including the transpose if built
+    uint64_t size_in_bytes() const {
+        return (v + 3) * sizeof(uint64_t) + offsets[v + 2] * (sizeof(uint32_t) + (weights ? sizeof(float) : 0)) + in_edges.size_in_bytes();
+    }
+
+    uint64_t reverse_index_size_in_bytes() const { return in_edges.size_in_bytes(); }
+
+    void sortEdgesByNodeId();
+
+    void finished();
+
+    void populate(std::tuple<uint64_t, uint64_t, double>* e_list);
+
+    // build the graph straight from the staged edges (both directions of undirected edges)
+    void populate(const EdgeList &edges);
+};
+
+
+#endif //ORACLE_CONTEST_CSRGRAPH_H
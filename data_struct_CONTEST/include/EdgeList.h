@@ -0,0 +1,112 @@
+#ifndef ORACLE_CONTEST_EDGELIST_H
+#define ORACLE_CONTEST_EDGELIST_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// A chunk of parsed edges, as 32-bit endpoints and float weights
+struct EdgeChunk {
+    std::vector<uint32_t> src;
+    std::vector<uint32_t> dst;
+    std::vector<float> weight;
+
+    uint64_t size() const { return src.size(); }
+};
+
+// Parse filename (an LDBC .e file) in large blocks, calling on_chunk for every
+// chunk of up to chunk_size edges. Weights are set to 1 if the file has no weight column.
+// Returns false (after printing an error) if the file cannot be read or a vertex id does not fit in 32 bits
+bool parse_edge_file(const std::string &filename, const std::function<void(EdgeChunk &)> &on_chunk, bool &weighted, uint64_t chunk_size = 1 << 20);
+
+// Compact staging area for the edges of a graph (12 bytes per edge of the .e file).
+// Undirected edges are stored once: graph builders get both directions from for_each_edge
+class EdgeList {
+    std::vector<EdgeChunk> chunks;
+    uint64_t num_file_edges;
+    uint64_t num_vertices;
+    uint64_t max_id;
+    bool undirected;
+    bool weighted;
+
+public:
+    EdgeList() : num_file_edges(0), num_vertices(0), max_id(0), undirected(false), weighted(false) {}
+
+    // load graphName.e; returns false on errors
+    bool load(const std::string &graphName, bool undirected);
+
+    // take edges already in memory (e.g. extracted from a graph, see Subgraph.h) as a directed graph
+    void assign(std::vector<EdgeChunk> edge_chunks, bool weighted);
+
+    // number of directed edges (each undirected edge counts twice, as in load_graph)
+    uint64_t size() const { return undirected ? 2 * num_file_edges : num_file_edges; }
+
+    // number of distinct vertex ids
+    uint64_t vertices() const { return num_vertices; }
+
+    uint64_t max_vertex_id() const { return max_id; }
+
+    bool is_undirected() const { return undirected; }
+
+    bool is_weighted() const { return weighted; }
+
+    const std::vector<EdgeChunk> &get_chunks() const { return chunks; }
+
+    // call f(src, dst, weight) for every directed edge, in the same order of the tuple list
+    // built by load_graph: edges of the file first, then (if undirected) the reversed ones
+    template<typename F>
+    void for_each_edge(F f) const {
+        for (uint64_t b = 0; b < num_blocks(); b++)
+            for_each_edge_in_block(b, f);
+    }
+
+    // edges split in blocks (one per chunk and direction) that can be visited in parallel;
+    // visiting all the blocks in order is the same as for_each_edge
+    uint64_t num_blocks() const { return undirected ? 2 * chunks.size() : chunks.size(); }
+
+    template<typename F>
+    void for_each_edge_in_block(uint64_t b, F f) const {
+        if (b < chunks.size()) {
+            const EdgeChunk &c = chunks[b];
+            for (uint64_t i = 0; i < c.size(); i++)
+                f(c.src[i], c.dst[i], c.weight[i]);
+        } else {
+            const EdgeChunk &c = chunks[b - chunks.size()];
+            for (uint64_t i = 0; i < c.size(); i++)
+                f(c.dst[i], c.src[i], c.weight[i]);
+        }
+    }
+};
+
+// Adapter exposing the tuple list built by load_graph with the same
+// for_each_edge interface of EdgeList, so that graph builders can consume both
+class TupleEdgeList {
+    std::tuple<uint64_t, uint64_t, double> *e_list;
+    uint64_t e;
+
+public:
+    TupleEdgeList(std::tuple<uint64_t, uint64_t, double> *e_list, uint64_t e) : e_list(e_list), e(e) {}
+
+    uint64_t size() const { return e; }
+
+    template<typename F>
+    void for_each_edge(F f) const {
+        for (uint64_t i = 0; i < e; i++)
+            f(std::get<0>(e_list[i]), std::get<1>(e_list[i]), std::get<2>(e_list[i]));
+    }
+
+    static const uint64_t BLOCK_SIZE = 1 << 20;
+
+    uint64_t num_blocks() const { return (e + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+    template<typename F>
+    void for_each_edge_in_block(uint64_t b, F f) const {
+        for (uint64_t i = b * BLOCK_SIZE; i < std::min(e, (b + 1) * BLOCK_SIZE); i++)
+            f(std::get<0>(e_list[i]), std::get<1>(e_list[i]), std::get<2>(e_list[i]));
+    }
+};
+
+#endif //ORACLE_CONTEST_EDGELIST_H
@@ -0,0 +1,309 @@
+#ifndef ORACLE_CONTEST_FRONTIER_H
+#define ORACLE_CONTEST_FRONTIER_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+
+// Frontier programming interface in the style of Ligra, templated on the graph type
+// (degree, for_each_neighbor, get_in_neighbors) and run on the ThreadPool:
+// - VertexSubset: a set of vertices, stored as a list of ids (sparse) and/or one flag per vertex (dense);
+// - edge_map: applies a functor to the edges leaving a subset and returns the subset of the targets
+//   it accepted, pushing along the out-edges of the subset or pulling along the in-edges of the
+//   candidate targets, whichever is cheaper;
+// - vertex_map / vertex_filter: apply a function / a predicate to the vertices of a subset.
+//
+// The functor F of edge_map provides
+//   bool cond(d)                 false once d needs no more updates (pull stops scanning its in-edges)
+//   bool update(s, d, w)         edge s -> d of weight w, called only by the thread owning d (pull)
+//   bool update_atomic(s, d, w)  same, called concurrently for the same d (push)
+// where update/update_atomic return true if d joins the output, at most once per d.
+
+class VertexSubset {
+    uint64_t n;
+    uint64_t count;
+    std::vector<uint64_t> ids;      // valid if has_ids
+    std::vector<uint8_t> flags;     // valid if has_flags
+    bool has_ids, has_flags;
+
+public:
+    // empty subset of [0, n)
+    explicit VertexSubset(uint64_t n) : n(n), count(0), has_ids(true), has_flags(false) {}
+
+    // {v}
+    VertexSubset(uint64_t n, uint64_t v) : n(n), count(1), ids(1, v), has_ids(true), has_flags(false) {}
+
+    // sparse subset; the order of ids is kept by vertex_map and by the pushes of edge_map
+    VertexSubset(uint64_t n, std::vector<uint64_t> ids) : n(n), count(ids.size()), ids(std::move(ids)), has_ids(true), has_flags(false) {}
+
+    // dense subset with count flags set
+    VertexSubset(uint64_t n, std::vector<uint8_t> flags, uint64_t count) : n(n), count(count), flags(std::move(flags)), has_ids(false), has_flags(true) {}
+
+    uint64_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+
+    uint64_t num_vertices() const { return n; }
+
+    bool is_dense() const { return has_flags; }
+
+    // membership test, after to_dense()
+    inline bool contains(uint64_t v) const { return flags[v] != 0; }
+
+    // the ids, after to_sparse()
+    const std::vector<uint64_t> &vertices() const { return ids; }
+
+    // add the flags (the ids are kept)
+    void to_dense() {
+        if (has_flags)
+            return;
+        flags.assign(n, 0);
+        ThreadPool::instance().parallel_for(0, count, [this](uint64_t i) { flags[ids[i]] = 1; });
+        has_flags = true;
+    }
+
+    // add the ids, sorted, from the flags (these are kept)
+    void to_sparse() {
+        if (has_ids)
+            return;
+        ThreadPool &pool = ThreadPool::instance();
+        const uint64_t block = 1 << 14;
+        uint64_t num_blocks = (n + block - 1) / block;
+        std::vector<uint64_t> offsets(num_blocks + 1, 0);
+        pool.parallel_for(0, num_blocks, [&](uint64_t b) {
+            for (uint64_t i = b * block; i < std::min(n, (b + 1) * block); i++)
+                offsets[b + 1] += flags[i];
+        }, 1);
+        for (uint64_t b = 0; b < num_blocks; b++)
+            offsets[b + 1] += offsets[b];
+        ids.resize(offsets[num_blocks]);
+        pool.parallel_for(0, num_blocks, [&](uint64_t b) {
+            uint64_t p = offsets[b];
+            for (uint64_t i = b * block; i < std::min(n, (b + 1) * block); i++)
+                if (flags[i])
+                    ids[p++] = i;
+        }, 1);
+        has_ids = true;
+    }
+
+    // f(v) for every v in the subset, in parallel
+    template<typename F>
+    void for_each(F f) const {
+        ThreadPool &pool = ThreadPool::instance();
+        if (has_ids)
+            pool.parallel_for(0, count, [&](uint64_t i) { f(ids[i]); });
+        else
+            pool.parallel_for(0, n, [&](uint64_t v) { if (flags[v]) f(v); });
+    }
+};
+
+// direction of edge_map
+enum class EdgeMapDirection {
+    AUTO,   // push if the frontier and its out-edges are at most threshold, pull otherwise
+    PUSH,
+    PULL
+};
+
+// sum of the out-degrees of the vertices of frontier
+template<typename G>
+uint64_t out_degree_sum(G &graph, VertexSubset &frontier) {
+    frontier.to_sparse();
+    const std::vector<uint64_t> &ids = frontier.vertices();
+    return ThreadPool::instance().parallel_reduce(0, ids.size(), (uint64_t)0, [&](uint64_t lo, uint64_t hi) {
+        uint64_t sum = 0;
+        for (uint64_t i = lo; i < hi; i++)
+            sum += graph.degree(ids[i]);
+        return sum;
+    }, [](uint64_t a, uint64_t b) { return a + b; });
+}
+
+// sum of the in-degrees of the vertices of subset
+template<typename G>
+uint64_t in_degree_sum(G &graph, VertexSubset &subset) {
+    subset.to_sparse();
+    const std::vector<uint64_t> &ids = subset.vertices();
+    return ThreadPool::instance().parallel_reduce(0, ids.size(), (uint64_t)0, [&](uint64_t lo, uint64_t hi) {
+        uint64_t sum = 0;
+        for (uint64_t i = lo; i < hi; i++)
+            sum += graph.in_degree(ids[i]);
+        return sum;
+    }, [](uint64_t a, uint64_t b) { return a + b; });
+}
+
+// apply f to the edges from frontier to the vertices satisfying f.cond, on a graph with m edges;
+// with AUTO, the pull direction is taken when the frontier and its out-edges exceed threshold
+// (0: m / 20). Returns the accepted targets: sparse after a push, dense after a pull
+template<typename G, typename F>
+VertexSubset edge_map(G &graph, uint64_t m, VertexSubset &frontier, F &f,
+                      EdgeMapDirection direction = EdgeMapDirection::AUTO, uint64_t threshold = 0) {
+    ThreadPool &pool = ThreadPool::instance();
+    uint64_t n = frontier.num_vertices();
+    if (direction == EdgeMapDirection::AUTO) {
+        if (!threshold)
+            threshold = m / 20;
+        direction = frontier.size() + out_degree_sum(graph, frontier) > threshold ? EdgeMapDirection::PULL : EdgeMapDirection::PUSH;
+    }
+
+    if (direction == EdgeMapDirection::PUSH) {
+        frontier.to_sparse();
+        const std::vector<uint64_t> &ids = frontier.vertices();
+        std::vector<uint64_t> next;
+        std::mutex mutex;
+        pool.parallel_for_range(0, ids.size(), [&](uint64_t lo, uint64_t hi) {
+            std::vector<uint64_t> local;
+            for (uint64_t i = lo; i < hi; i++) {
+                uint64_t s = ids[i];
+                graph.for_each_neighbor(s, [&](uint64_t d, double w) {
+                    if (f.cond(d) && f.update_atomic(s, d, w))
+                        local.push_back(d);
+                });
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            next.insert(next.end(), local.begin(), local.end());
+        });
+        return VertexSubset(n, std::move(next));
+    }
+
+    // pull: build the transpose before going parallel
+    frontier.to_dense();
+    if (n > 0)
+        graph.in_degree(0);
+    std::vector<uint8_t> next(n, 0);
+    uint64_t count = pool.parallel_reduce(0, n, (uint64_t)0, [&](uint64_t lo, uint64_t hi) {
+        uint64_t accepted = 0;
+        for (uint64_t d = lo; d < hi; d++) {
+            if (!f.cond(d))
+                continue;
+            for (const auto &edge : graph.get_in_neighbors(d)) {
+                if (frontier.contains(edge.first) && f.update(edge.first, d, edge.second) && !next[d]) {
+                    next[d] = 1;
+                    accepted++;
+                }
+                if (!f.cond(d))
+                    break;
+            }
+        }
+        return accepted;
+    }, [](uint64_t a, uint64_t b) { return a + b; });
+    return VertexSubset(n, std::move(next), count);
+}
+
+// f(v) for every v in subset
+template<typename F>
+void vertex_map(const VertexSubset &subset, F f) {
+    subset.for_each(f);
+}
+
+// the vertices of subset satisfying pred (dense)
+template<typename P>
+VertexSubset vertex_filter(const VertexSubset &subset, P pred) {
+    uint64_t n = subset.num_vertices();
+    std::vector<uint8_t> flags(n, 0);
+    subset.for_each([&](uint64_t v) { flags[v] = pred(v) ? 1 : 0; });
+    uint64_t count = ThreadPool::instance().parallel_reduce(0, n, (uint64_t)0, [&](uint64_t lo, uint64_t hi) {
+        uint64_t c = 0;
+        for (uint64_t v = lo; v < hi; v++)
+            c += flags[v];
+        return c;
+    }, [](uint64_t a, uint64_t b) { return a + b; });
+    return VertexSubset(n, std::move(flags), count);
+}
+
+// BFS levels in dist (LONG_MAX if unreached) and the weight sum of the BFS tree, with the same
+// results as the sequential queue-based bfs of GraphAlgorithm (not the block bfs of GridGraph,
+// which breaks ties between parents differently). Every level is an edge_map that
+// marks the new vertices (a pull stops at the first frontier in-neighbor of each vertex). Then
+// each new vertex gets its parent, the earliest vertex of the frontier with an edge to it, from
+// its in-edges (if the edge_map pulled, so that the transpose exists) or from the out-edges of
+// the frontier, whichever are fewer. Every parent lists its new children in the order of its edges,
+// which yields the next frontier in the order of the sequential queue, and the weight of the first
+// edge to each child
+template<typename G>
+double frontier_bfs(G &graph, uint64_t n, uint64_t m, uint64_t source, uint64_t *dist) {
+    ThreadPool &pool = ThreadPool::instance();
+    const uint64_t NONE = UINT64_MAX;
+    std::vector<uint64_t> parent(n, NONE);  // position of the parent in the frontier, until listed
+    std::vector<uint64_t> pos(n);           // position of the frontier vertices
+    pool.parallel_for(0, n, [&](uint64_t i) { dist[i] = LONG_MAX; });
+
+    struct Update {
+        uint64_t *dist;
+        uint64_t level;
+
+        inline bool cond(uint64_t d) const {
+            return __atomic_load_n(&dist[d], __ATOMIC_RELAXED) == (uint64_t)LONG_MAX;
+        }
+
+        inline bool update(uint64_t, uint64_t d, double) {
+            dist[d] = level;
+            return true;
+        }
+
+        inline bool update_atomic(uint64_t, uint64_t d, double) {
+            uint64_t expected = LONG_MAX;
+            return __atomic_compare_exchange_n(&dist[d], &expected, level, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+    };
+
+    double sum = 0;
+    dist[source] = 0;
+    VertexSubset frontier(n, source);
+    for (uint64_t level = 1; !frontier.empty(); level++) {
+        const std::vector<uint64_t> &ids = frontier.vertices();
+        pool.parallel_for(0, ids.size(), [&](uint64_t i) { pos[ids[i]] = i; });
+        Update update = {dist, level};
+        VertexSubset reached = edge_map(graph, m, frontier, update);
+
+        // parents of the new vertices (the frontier is the vertices at level - 1)
+        if (reached.is_dense() && in_degree_sum(graph, reached) < out_degree_sum(graph, frontier)) {
+            const std::vector<uint64_t> &new_ids = reached.vertices();
+            pool.parallel_for(0, new_ids.size(), [&](uint64_t i) {
+                uint64_t d = new_ids[i], p = NONE;
+                for (const auto &edge : graph.get_in_neighbors(d))
+                    if (dist[edge.first] == level - 1)
+                        p = std::min(p, pos[edge.first]);
+                parent[d] = p;
+            });
+        } else {
+            pool.parallel_for(0, ids.size(), [&](uint64_t i) {
+                graph.for_each_neighbor(ids[i], [&](uint64_t d, double) {
+                    if (__atomic_load_n(&dist[d], __ATOMIC_RELAXED) != level)
+                        return;
+                    uint64_t old = __atomic_load_n(&parent[d], __ATOMIC_RELAXED);
+                    while (i < old && !__atomic_compare_exchange_n(&parent[d], &old, i, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+                });
+            });
+        }
+
+        // slots of the children of each parent in the next frontier
+        std::vector<uint64_t> offsets(ids.size() + 1, 0);
+        vertex_map(reached, [&](uint64_t d) { __atomic_fetch_add(&offsets[parent[d] + 1], 1, __ATOMIC_RELAXED); });
+        for (uint64_t i = 0; i < ids.size(); i++)
+            offsets[i + 1] += offsets[i];
+        std::vector<uint64_t> next(reached.size());
+        std::vector<double> weights(reached.size());
+        pool.parallel_for(0, ids.size(), [&](uint64_t i) {
+            uint64_t p = offsets[i];
+            if (p == offsets[i + 1])
+                return;
+            graph.for_each_neighbor(ids[i], [&](uint64_t d, double w) {
+                if (parent[d] == i) {
+                    parent[d] = NONE;
+                    weights[p] = w;
+                    next[p++] = d;
+                }
+            });
+        });
+        // same summation order as the sequential bfs
+        for (uint64_t i = 0; i < next.size(); i++)
+            sum += weights[i];
+        frontier = VertexSubset(n, std::move(next));
+    }
+    return sum;
+}
+
+#endif //ORACLE_CONTEST_FRONTIER_H
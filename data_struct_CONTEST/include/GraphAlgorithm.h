@@ -1,6 +1,7 @@
 #ifndef ORACLE_CONTEST_GRAPHALGORITHM_H
 #define ORACLE_CONTEST_GRAPHALGORITHM_H
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -9,24 +10,129 @@
 #include <climits>
 #include <set>
 #include <string>
+#include <type_traits>
+#include <vector>
+#include "Betweenness.h"
+#include "EdgeList.h"
+#include "Frontier.h"
+#include "HyperANF.h"
+#include "ResultWriter.h"
+#include "KCore.h"
+#include "LocalityProfiler.h"
+#include "Louvain.h"
+#include "PageRank.h"
+#include "SCC.h"
+#include "Subgraph.h"
+#include "TraversalState.h"
+
+// detects graph types that store dense neighborhoods as bitmaps (see HybridGraph)
+template<typename T>
+class has_bitmap_adjacency {
+    template<typename U> static char test(decltype(&U::template for_each_unvisited<void (*)(uint64_t, double)>));
+    template<typename U> static long test(...);
+public:
+    static const bool value = sizeof(test<T>(0)) == sizeof(char);
+};
+
+// detects graph types that store edges in a grid of blocks (see GridGraph)
+template<typename T>
+class has_grid_blocks {
+    template<typename U> static char test(decltype(&U::grid_size));
+    template<typename U> static long test(...);
+public:
+    static const bool value = sizeof(test<T>(0)) == sizeof(char);
+};
+
+// detects graph types whose neighbor visit can be stopped and resumed (see CSRGraph::NeighborCursor)
+template<typename T>
+class has_neighbor_cursor {
+    template<typename U> static char test(decltype(&U::cursor));
+    template<typename U> static long test(...);
+public:
+    static const bool value = sizeof(test<T>(0)) == sizeof(char);
+};
+
+// neighbors of the vertices on the DFS path, read through the cursors of the graph
+template<typename T>
+class CursorNeighbors {
+    const T &graph;
+
+public:
+    typedef typename T::NeighborCursor Cursor;
+
+    explicit CursorNeighbors(const T &graph) : graph(graph) {}
+
+    Cursor open(uint64_t x) { return graph.cursor(x); }
+
+    void close(const Cursor &) {}
+};
+
+// neighbors of the vertices on the DFS path, copied (in the order of for_each_neighbor) at the end of
+// a buffer when the vertex is reached, and dropped when it is left; for the other graph types
+template<typename T>
+class CopiedNeighbors {
+    T &graph;
+    std::vector<std::pair<uint64_t, double> > pending;
+
+public:
+    class Cursor {
+        const std::vector<std::pair<uint64_t, double> > *pending;
+        uint64_t first, i, end;
+        friend class CopiedNeighbors;
+
+    public:
+        Cursor(const std::vector<std::pair<uint64_t, double> > *pending, uint64_t first, uint64_t end) : pending(pending), first(first), i(first), end(end) {}
+
+        inline bool next(uint64_t &to, double &weight) {
+            if (i == end)
+                return false;
+            to = (*pending)[i].first;
+            weight = (*pending)[i++].second;
+            return true;
+        }
+    };
+
+    explicit CopiedNeighbors(T &graph) : graph(graph) {}
+
+    Cursor open(uint64_t x) {
+        const uint64_t first = pending.size();
+        graph.for_each_neighbor(x, [this](uint64_t to, double weight) { pending.push_back(std::make_pair(to, weight)); });
+        return Cursor(&pending, first, pending.size());
+    }
+
+    void close(const Cursor &cursor) { pending.resize(cursor.first); }
+};
+
+// bfs variant of a graph type
+struct queue_bfs_tag {};
+struct bitmap_bfs_tag {};
+struct grid_bfs_tag {};
+
+template<typename T>
+struct bfs_tag {
+    typedef typename std::conditional<has_grid_blocks<T>::value, grid_bfs_tag,
+        typename std::conditional<has_bitmap_adjacency<T>::value, bitmap_bfs_tag, queue_bfs_tag>::type>::type type;
+};
 
 template<typename T>
 class GraphAlgorithm {
-    uint64_t v, e, last;
-    uint64_t *dist;
-    bool *used;
+    uint64_t v, e;
+    TraversalState state;   // used by the single-traversal bfs/dfs
     T *graph;
+    LocalityProfiler profiler;  // last bfs/dfs, in the instrumentation build
+    std::vector<double> scores; // result of the last real-valued kernel (betweenness, pagerank)
+
+    // bytes that a traversal may touch: graph, dist and used
+    uint64_t footprint() {
+        return graph->size_in_bytes() + (v + 2) * (sizeof(uint64_t) + sizeof(bool));
+    }
 
 public:
-    GraphAlgorithm(uint64_t v, uint64_t e) : v(v), e(e) {
-        used = new bool[v + 2];
-        dist = new uint64_t[v + 2];
+    GraphAlgorithm(uint64_t v, uint64_t e) : v(v), e(e), state(v + 2) {
         graph = new T(v, e);
     }
 
     ~GraphAlgorithm() {
-        delete[] used;
-        delete[] dist;
         delete graph;
     }
 
@@ -35,6 +141,11 @@ public:
         graph->populate(edges);
     }
     
+    // build the graph straight from the staged edges
+    void populate(const EdgeList &edges) {
+        graph->populate(edges);
+    }
+
     // required
     void finished() {
         graph->finished();
@@ -55,66 +166,494 @@ public:
         graph->add_edge(from, to, weight);
     }
 
-    void write_results(std::string filename) {
-        std::ofstream outfile(filename);
-        for (uint64_t i = 0; i <= v; i++){
-            outfile << i << " " << dist[i] << std::endl; 
-        }
+    // memory used by the graph data structure, and by its transpose (if built)
+    uint64_t size_in_bytes() {
+        return graph->size_in_bytes();
+    }
+
+    uint64_t reverse_index_size_in_bytes() {
+        return graph->reverse_index_size_in_bytes();
+    }
+
+    uint64_t num_vertices() const { return v; }
+
+    // the graph data structure (e.g. to take snapshots of a VersionedGraph)
+    T &structure() { return *graph; }
+
+    // memory-access locality of the last bfs/dfs (empty unless built with make profile)
+    const LocalityProfiler &locality_profile() const { return profiler; }
+
+    // counters of the last bfs/dfs (all zero unless built with make counters)
+    const TraversalCounters &counters() const { return state.counters; }
+
+    // results of the last traversal or kernel, v + 2 entries
+    const uint64_t *results() const { return state.dist; }
+
+    void write_results(std::string filename, ResultFormat format = ResultFormat::TEXT) {
+        ResultWriter writer(format);
+        writer.write(filename, state.dist, v + 1);
+    }
+
+    // write the scores of the last real-valued kernel (always as text)
+    void write_scores(ResultWriter &writer, std::string filename) {
+        writer.write_scores(filename, scores.data(), scores.size());
+    }
+
+    // snapshot the current results and write them in background,
+    // so that the next traversal can start right away
+    void write_results_async(ResultWriter &writer, std::string filename) {
+        writer.write_async(filename, state.dist, v + 1);
     }
 
     // the bfs populate diff with the corresponding 
     // layer of the BFS tree for each vertex
     double bfs(uint64_t cur_vertex) {
+        LOCALITY_SCOPE(profiler, "bfs", footprint());
+        return bfs(cur_vertex, state);
+    }
+
+    // same as bfs, with the results left in s: the graph is only read,
+    // so traversals with different states can run concurrently
+    double bfs(uint64_t cur_vertex, TraversalState &s) {
+        return bfs(cur_vertex, s, typename bfs_tag<T>::type());
+    }
+
+private:
+    // same visit of the generic bfs, but the neighbors of dense vertices
+    // are filtered with a word-wise AND against the unvisited vertices
+    double bfs(uint64_t cur_vertex, TraversalState &s, bitmap_bfs_tag) {
         // initialization
+        uint64_t words = (v + 2 + 63) / 64;
+        if (!s.visited)
+            s.visited = new uint64_t[words];
+        uint64_t *visited = s.visited;
+        uint64_t *dist = s.dist;
+        memset(visited, 0, sizeof(uint64_t) * words);
+        for (uint64_t i = 0; i < v + 2; i++)
+            dist[i] = LONG_MAX;
+        s.dirty = true;
+        TRAVERSAL_COUNT_RESET(s);
+        double sum = 0;
+        std::queue<uint64_t> q;
+        q.push(cur_vertex);
+        visited[cur_vertex >> 6] |= 1ULL << (cur_vertex & 63);
+        dist[cur_vertex] = 0;
+        TRAVERSAL_COUNT_LEVEL(s, 0, 1);
+
+        // main loop
+        while (!q.empty()) {
+            cur_vertex = q.front();
+            q.pop();
+            LOCALITY_LEVEL(dist[cur_vertex]);
+            LOCALITY_ACCESS(DIST, &dist[cur_vertex]);
+            // the visited neighbors are filtered out word-wise: all the edges count as scanned
+            TRAVERSAL_COUNT(s, vertices, 1);
+            TRAVERSAL_COUNT(s, edges, graph->degree(cur_vertex));
+            graph->for_each_unvisited(cur_vertex, visited, [&](uint64_t to, double weight) {
+                LOCALITY_ACCESS(USED, &visited[to >> 6]);
+                LOCALITY_ACCESS(DIST, &dist[to]);
+                visited[to >> 6] |= 1ULL << (to & 63);
+                dist[to] = dist[cur_vertex] + 1;
+                q.push(to);
+                sum = sum + weight;
+                TRAVERSAL_COUNT_LEVEL(s, dist[to], 1);
+            });
+        }
+        // every reached vertex but the source was found by one of the scanned edges
+        TRAVERSAL_COUNT(s, redundant, s.counters.edges - (s.counters.vertices - 1));
+        return sum;
+    }
+
+    // level-synchronous bfs over the blocks of the grid: at every level, one task per destination
+    // range walks its column of blocks, reading the frontier sources of each row of blocks (a slice
+    // of the sorted frontier) and writing only its own slice of dist/used, so that both slices stay
+    // in cache. A vertex is reached from its smallest parent in the previous level (first edge of
+    // the parent to it): distances are the same as the queue-based bfs, the sum may differ because
+    // of the tie-breaking, but does not depend on the number of threads. The locality profiler only
+    // records the thread that started the traversal, so the profile build runs the columns on it
+    double bfs(uint64_t cur_vertex, TraversalState &s, grid_bfs_tag) {
+        ThreadPool &pool = ThreadPool::instance();
+        const uint64_t P = graph->grid_size(), chunk = graph->chunk_size();
+        bool *used = s.used;
+        uint64_t *dist = s.dist;
+        memset(used, 0, sizeof(bool) * (v + 2));
+        for (uint64_t i = 0; i < v + 2; i++)
+            dist[i] = LONG_MAX;
+        s.dirty = true;
+        double sum = 0;
+        std::vector<uint64_t> frontier(1, cur_vertex), band(P + 1);
+        std::vector<std::vector<uint64_t> > next(P);
+        std::vector<double> sums(P);
+        used[cur_vertex] = true;
+        dist[cur_vertex] = 0;
+        TRAVERSAL_COUNT_RESET(s);
+        TRAVERSAL_COUNT_LEVEL(s, 0, 1);
+
+        for (uint64_t level = 1; !frontier.empty(); level++) {
+            // frontier[band[i] .. band[i + 1]) are the sources in range i
+            for (uint64_t i = 0; i <= P; i++)
+                band[i] = std::lower_bound(frontier.begin(), frontier.end(), i * chunk) - frontier.begin();
+            TRAVERSAL_COUNT(s, vertices, frontier.size());
+            LOCALITY_LEVEL(level - 1);
+            auto column = [&](uint64_t j) {
+                std::vector<uint64_t> &reached = next[j];
+                double partial = 0;
+                reached.clear();
+                for (uint64_t i = 0; i < P; i++)
+                    graph->for_each_block_edge(i, j, frontier.data() + band[i], band[i + 1] - band[i], [&](uint64_t, uint64_t to, double weight) {
+                        TRAVERSAL_COUNT_ATOMIC(s, edges, 1);
+                        LOCALITY_ACCESS(USED, &used[to]);
+                        if (!used[to]) {
+                            LOCALITY_ACCESS(DIST, &dist[to]);
+                            used[to] = true;
+                            dist[to] = level;
+                            reached.push_back(to);
+                            partial += weight;
+                        } else {
+                            TRAVERSAL_COUNT_ATOMIC(s, redundant, 1);
+                        }
+                    });
+                std::sort(reached.begin(), reached.end());
+                sums[j] = partial;
+            };
+#ifdef LOCALITY_PROFILE
+            // the profiler only sees the accesses of its own thread: the columns run here, one
+            // after the other, as on a single worker
+            for (uint64_t j = 0; j < P; j++)
+                column(j);
+#else
+            pool.parallel_for(0, P, column, 1);
+#endif
+            frontier.clear();
+            for (uint64_t j = 0; j < P; j++) {
+                frontier.insert(frontier.end(), next[j].begin(), next[j].end());
+                sum += sums[j];
+            }
+            if (!frontier.empty())
+                TRAVERSAL_COUNT_LEVEL(s, level, frontier.size());
+        }
+        return sum;
+    }
+
+    double bfs(uint64_t cur_vertex, TraversalState &s, queue_bfs_tag) {
+        // initialization
+        bool *used = s.used;
+        uint64_t *dist = s.dist;
         memset(used, 0, sizeof(bool) * (v + 2));
         for (uint64_t i = 0; i < v + 2; i++)
             dist[i] = LONG_MAX; 
+        s.dirty = true;
+        TRAVERSAL_COUNT_RESET(s);
         double sum = 0;
         std::queue<uint64_t> q;
         q.push(cur_vertex);
         used[cur_vertex] = true;
         dist[cur_vertex] = 0;
+        TRAVERSAL_COUNT_LEVEL(s, 0, 1);
 
-        // main loop
+        // main loop; neighbors are visited through the graph's inlined visitor
         while (!q.empty()) {
             cur_vertex = q.front();
             q.pop();
-            for (auto& to : graph->get_neighbors(cur_vertex)) {
-                if (!used[to.first]) {
-                    used[to.first] = true;
-                    dist[to.first] = dist[cur_vertex] + 1;
-                    q.push(to.first);
-                    sum = sum + to.second;
+            LOCALITY_LEVEL(dist[cur_vertex]);
+            LOCALITY_ACCESS(DIST, &dist[cur_vertex]);
+            const uint64_t next_dist = dist[cur_vertex] + 1;
+            TRAVERSAL_COUNT(s, vertices, 1);
+            graph->for_each_neighbor(cur_vertex, [&](uint64_t to, double weight) {
+                LOCALITY_ACCESS(USED, &used[to]);
+                TRAVERSAL_COUNT(s, edges, 1);
+                if (!used[to]) {
+                    LOCALITY_ACCESS(DIST, &dist[to]);
+                    used[to] = true;
+                    dist[to] = next_dist;
+                    q.push(to);
+                    sum = sum + weight;
+                    TRAVERSAL_COUNT_LEVEL(s, next_dist, 1);
+                } else {
+                    TRAVERSAL_COUNT(s, redundant, 1);
                 }
-            }
+            });
         }
         return sum;
     }
 
+public:
+    // same results as bfs, computed level by level with edge_map (see Frontier.h),
+    // pushing or pulling on the ThreadPool
+    double bfs_frontier(uint64_t cur_vertex) {
+        return bfs_frontier(cur_vertex, state);
+    }
+
+    double bfs_frontier(uint64_t cur_vertex, TraversalState &s) {
+        s.dirty = true;
+        return frontier_bfs(*graph, v + 2, e, cur_vertex, s.dist);
+    }
+
     // the dfs populate diff with the visiting 
     // order for each vertex
-    double dfs_recursion(uint64_t cur_vertex) {
-        double sum = 0;
-        used[cur_vertex] = true;
-        for (auto& to : graph->get_neighbors(cur_vertex)) {
-            if (!used[to.first]) {
-                dist[to.first] = ++last;
-                sum += to.second;
-                sum += dfs_recursion(to.first);
+    // (iterative, so that the depth of the graph is not bounded by the call stack: every vertex on
+    // the path keeps a cursor on its next neighbor, so neighbors are visited in the order of
+    // for_each_neighbor; sum adds up as in the recursive formulation, the weight of the tree edge
+    // and then the sum of the subtree)
+    double dfs_iterative(uint64_t cur_vertex, TraversalState &s) {
+        return dfs_iterative(cur_vertex, s, std::integral_constant<bool, has_neighbor_cursor<T>::value>());
+    }
+
+    double dfs_iterative(uint64_t cur_vertex, TraversalState &s, std::true_type) {
+        CursorNeighbors<T> neighbors(*graph);
+        return dfs_iterative(cur_vertex, s, neighbors);
+    }
+
+    double dfs_iterative(uint64_t cur_vertex, TraversalState &s, std::false_type) {
+        CopiedNeighbors<T> neighbors(*graph);
+        return dfs_iterative(cur_vertex, s, neighbors);
+    }
+
+    template<typename Neighbors>
+    double dfs_iterative(uint64_t cur_vertex, TraversalState &s, Neighbors &neighbors) {
+        struct Frame {
+            typename Neighbors::Cursor cursor;
+            double sum;
+        };
+        std::vector<Frame> frames;
+        auto expand = [&](uint64_t x) {
+            LOCALITY_ACCESS(USED, &s.used[x]);
+            s.used[x] = true;
+            TRAVERSAL_COUNT(s, vertices, 1);
+            frames.push_back(Frame{neighbors.open(x), 0});
+        };
+        expand(cur_vertex);
+        while (true) {
+            Frame &frame = frames.back();
+            uint64_t to;
+            double weight;
+            if (!frame.cursor.next(to, weight)) {
+                const double sum = frame.sum;
+                neighbors.close(frame.cursor);
+                frames.pop_back();
+                if (frames.empty())
+                    return sum;
+                frames.back().sum += sum;
+                continue;
+            }
+            LOCALITY_ACCESS(USED, &s.used[to]);
+            TRAVERSAL_COUNT(s, edges, 1);
+            if (!s.used[to]) {
+                LOCALITY_ACCESS(DIST, &s.dist[to]);
+                s.dist[to] = ++s.last;
+                frame.sum += weight;
+                expand(to);
+            } else {
+                TRAVERSAL_COUNT(s, redundant, 1);
             }
         }
-        return sum;
     }
 
     double dfs(uint64_t cur_vertex) {
+        LOCALITY_SCOPE(profiler, "dfs", footprint());
+        return dfs(cur_vertex, state);
+    }
+
+    double dfs(uint64_t cur_vertex, TraversalState &s) {
         // initialization
-        memset(used, 0, sizeof(bool) * (v + 2));
+        memset(s.used, 0, sizeof(bool) * (v + 2));
         for (uint64_t i = 0; i < v + 2; i++)
-            dist[i] = LONG_MAX;
+            s.dist[i] = LONG_MAX;
+        s.dist[cur_vertex] = 0;
+        s.last = 0;
+        s.dirty = true;
+        TRAVERSAL_COUNT_RESET(s);
+        return dfs_iterative(cur_vertex, s);
+    }
+
+    // the scc populate dist with the smallest vertex id of the
+    // strongly connected component of each vertex (see SCC.h);
+    // returns the number of components
+    uint64_t scc() {
+        state.dirty = true;
+        return strongly_connected_components(*graph, v + 2, state.dist);
+    }
+
+    // the kcore populate dist with the core number of each vertex
+    // (see KCore.h); returns the largest one
+    uint64_t kcore() {
+        state.dirty = true;
+        return core_numbers(*graph, v + 2, state.dist);
+    }
+
+    // the louvain populate dist with the community of each vertex, labeled by its smallest
+    // vertex (see Louvain.h), on the graph taken as undirected; returns the modularity and sets
+    // levels to the number of levels of coarsening
+    double louvain(bool undirected, double threshold, uint64_t &levels) {
+        state.dirty = true;
+        return louvain_communities(*graph, v + 2, undirected, threshold, state.dist, levels);
+    }
+
+    // the betweenness populate scores with the betweenness centrality of each vertex (see
+    // Betweenness.h), accumulating the dependencies of sources (all the ids in [0, v] if empty)
+    // multiplied by scale
+    void betweenness(const std::vector<uint64_t> &sources, double scale = 1) {
+        scores.assign(v + 2, 0);
+        if (sources.empty())
+            betweenness_centrality(*graph, v + 2, sample_sources(v + 1, v + 1, 0), scale, scores.data());
+        else
+            betweenness_centrality(*graph, v + 2, sources, scale, scores.data());
+    }
+
+    const std::vector<double> &score_results() const { return scores; }
+
+    // the pagerank populate scores with the rank of each vertex (see PageRank.h), iterating
+    // max_iterations times or until the L1 change is below epsilon (left in delta);
+    // returns the number of iterations
+    uint64_t pagerank(double damping, uint64_t max_iterations, double epsilon, double &delta) {
+        scores.assign(v + 2, 0);
+        return page_rank(*graph, v + 2, damping, max_iterations, epsilon, scores.data(), [this](const double *contrib, double *sums) {
+            gather(contrib, sums, std::integral_constant<bool, has_grid_blocks<T>::value>());
+        }, delta);
+    }
+
+    // the anf populate scores with the harmonic centrality of each vertex, estimated with
+    // HyperANF (see HyperANF.h) with 2^log2m registers per counter; returns the neighborhood function
+    NeighborhoodFunction anf(unsigned log2m, uint64_t seed, uint64_t max_distance = 0) {
+        scores.assign(v + 2, 0);
+        return hyper_anf(*graph, v + 2, log2m, seed, max_distance, scores.data(), [this](const HyperLogLogCounters &prev, HyperLogLogCounters &next) {
+            merge_counters(prev, next, std::integral_constant<bool, has_grid_blocks<T>::value>());
+        });
+    }
+
+private:
+    // sums[d] = sum of contrib[s] over the edges s -> d: pull over the transpose
+    void gather(const double *contrib, double *sums, std::false_type) {
+        gather_in_edges(*graph, v + 2, contrib, sums);
+    }
+
+    // on the grid, one task per destination range walks its column of blocks, so that it writes
+    // only its slice of sums and reads one slice of contrib at a time (no transpose needed)
+    void gather(const double *contrib, double *sums, std::true_type) {
+        const uint64_t P = graph->grid_size(), chunk = graph->chunk_size();
+        ThreadPool::instance().parallel_for(0, P, [&](uint64_t j) {
+            std::fill(sums + j * chunk, sums + std::min(v + 2, (j + 1) * chunk), 0.0);
+            for (uint64_t i = 0; i < P; i++)
+                graph->for_each_block_edge(i, j, [&](uint64_t s, uint64_t d, double) { sums[d] += contrib[s]; });
+        }, 1);
+    }
+
+    // next[d] |= prev[s] over the edges s -> d: pull over the transpose
+    void merge_counters(const HyperLogLogCounters &prev, HyperLogLogCounters &next, std::false_type) {
+        union_in_edges(*graph, v + 2, prev, next);
+    }
+
+    // on the grid, by columns of blocks as in gather: every task merges into its own slice of counters
+    void merge_counters(const HyperLogLogCounters &prev, HyperLogLogCounters &next, std::true_type) {
+        const uint64_t P = graph->grid_size(), m = prev.registers_per_counter();
+        ThreadPool::instance().parallel_for(0, P, [&](uint64_t j) {
+            for (uint64_t i = 0; i < P; i++)
+                graph->for_each_block_edge(i, j, [&](uint64_t s, uint64_t d, double) { HyperLogLogCounters::merge(next[d], prev[s], m); });
+        }, 1);
+    }
+
+public:
+
+    // subgraph induced by vertices, with dense relabeled ids (see Subgraph.h)
+    Subgraph subgraph(const std::vector<uint64_t> &vertices) {
+        return induced_subgraph(*graph, v + 2, vertices);
+    }
+
+    // vertices within k hops from any of seeds (seeds included)
+    std::vector<uint64_t> neighborhood(const std::vector<uint64_t> &seeds, uint64_t k) {
+        return khop_neighborhood(*graph, v + 2, seeds, k);
+    }
+
+    // vertices within k hops from cur_vertex (cur_vertex included): a bfs stopped at depth k,
+    // touching only the vertices it reaches; dist is LONG_MAX for all the others
+    uint64_t khop(uint64_t cur_vertex, uint64_t k) {
+        return khop(cur_vertex, k, state);
+    }
+
+    uint64_t khop(uint64_t cur_vertex, uint64_t k, TraversalState &s) {
+        s.reset();
+        uint64_t *dist = s.dist;
+        // the touched list doubles as the bfs queue
+        std::vector<uint64_t> &queue = s.touched;
+        queue.push_back(cur_vertex);
         dist[cur_vertex] = 0;
-        last = 0;
-        // recursion
-        return dfs_recursion(cur_vertex);
+
+        // vertices are dequeued by increasing depth: stop at the first one at depth k
+        TRAVERSAL_COUNT_RESET(s);
+        TRAVERSAL_COUNT_LEVEL(s, 0, 1);
+        for (uint64_t head = 0; head < queue.size() && dist[queue[head]] < k; head++) {
+            cur_vertex = queue[head];
+            const uint64_t next_dist = dist[cur_vertex] + 1;
+            TRAVERSAL_COUNT(s, vertices, 1);
+            graph->for_each_neighbor(cur_vertex, [&](uint64_t to, double) {
+                TRAVERSAL_COUNT(s, edges, 1);
+                if (dist[to] == (uint64_t)LONG_MAX) {
+                    dist[to] = next_dist;
+                    queue.push_back(to);
+                    TRAVERSAL_COUNT_LEVEL(s, next_dist, 1);
+                } else {
+                    TRAVERSAL_COUNT(s, redundant, 1);
+                }
+            });
+        }
+        return queue.size();
+    }
+
+    // number of hops from source to target (LONG_MAX if unreachable), with a bidirectional bfs
+    // expanding one level of the smaller frontier at a time: forward along out-edges (dist),
+    // backward along in-edges (rdist, the reverse index is built on first use).
+    // Only the vertices explored by the two searches are touched
+    uint64_t distance(uint64_t source, uint64_t target) {
+        return distance(source, target, state);
+    }
+
+    uint64_t distance(uint64_t source, uint64_t target, TraversalState &s) {
+        s.reset();
+        uint64_t *dist = s.dist;
+        uint64_t *rdist = s.reverse_dist();
+        dist[source] = 0;
+        rdist[target] = 0;
+        s.touched.push_back(source);
+        s.touched.push_back(target);
+        if (source == target)
+            return 0;
+
+        std::vector<uint64_t> forward(1, source), backward(1, target), next;
+        uint64_t forward_depth = 0, backward_depth = 0, best = LONG_MAX;
+        while (!forward.empty() && !backward.empty()) {
+            next.clear();
+            if (forward.size() <= backward.size()) {
+                forward_depth++;
+                for (uint64_t cur_vertex : forward)
+                    graph->for_each_neighbor(cur_vertex, [&](uint64_t to, double) {
+                        if (dist[to] == (uint64_t)LONG_MAX) {
+                            dist[to] = forward_depth;
+                            s.touched.push_back(to);
+                            next.push_back(to);
+                            if (rdist[to] != (uint64_t)LONG_MAX)
+                                best = std::min(best, forward_depth + rdist[to]);
+                        }
+                    });
+                forward.swap(next);
+            } else {
+                backward_depth++;
+                for (uint64_t cur_vertex : backward)
+                    graph->for_each_in_neighbor(cur_vertex, [&](uint64_t from, double) {
+                        if (rdist[from] == (uint64_t)LONG_MAX) {
+                            rdist[from] = backward_depth;
+                            s.touched.push_back(from);
+                            next.push_back(from);
+                            if (dist[from] != (uint64_t)LONG_MAX)
+                                best = std::min(best, dist[from] + backward_depth);
+                        }
+                    });
+                backward.swap(next);
+            }
+            // no path shorter than the explored depths can be found anymore
+            if (best <= forward_depth + backward_depth)
+                return best;
+        }
+        return best;
     }
 
 };
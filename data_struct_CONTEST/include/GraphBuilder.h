@@ -0,0 +1,113 @@
+#ifndef ORACLE_CONTEST_GRAPHBUILDER_H
+#define ORACLE_CONTEST_GRAPHBUILDER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+
+// Parallel counting sort of edges by source vertex, shared by the graph builders.
+// Edges is any edge source exposing num_blocks() and for_each_edge_in_block(b, f),
+// where visiting the blocks in order gives the edges in their original order.
+
+// offsets[0..n] = CSR offsets of the edges (vertex ids in [0, n))
+template<typename Edges>
+void count_degrees(const Edges &edges, uint64_t n, uint64_t *offsets) {
+    std::fill(offsets, offsets + n + 1, 0);
+    ThreadPool::instance().parallel_for(0, edges.num_blocks(), [&](uint64_t b) {
+        edges.for_each_edge_in_block(b, [offsets](uint64_t from, uint64_t, double) {
+            __atomic_fetch_add(&offsets[from + 1], 1, __ATOMIC_RELAXED);
+        });
+    }, 1);
+    for (uint64_t i = 0; i < n; i++)
+        offsets[i + 1] += offsets[i];
+}
+
+// call emit(position, to, weight) for every edge, where position is its CSR slot given
+// the offsets computed by count_degrees; edges with the same source keep their order.
+// With more than one thread, edges are first scattered to buckets of vertices with about the same
+// number of edges (in parallel over blocks), then every bucket is sorted on its own
+// (in parallel over buckets), using 16 bytes per edge of temporary memory; ids must fit in 32 bits
+template<typename Edges, typename Emit>
+void scatter_edges(const Edges &edges, uint64_t n, const uint64_t *offsets, Emit emit) {
+    ThreadPool &pool = ThreadPool::instance();
+    uint64_t total = offsets[n];
+    std::vector<uint64_t> cursor(offsets, offsets + n);
+    if (pool.size() == 1 || total < (1 << 16)) {
+        for (uint64_t b = 0; b < edges.num_blocks(); b++)
+            edges.for_each_edge_in_block(b, [&](uint64_t from, uint64_t to, double weight) {
+                emit(cursor[from]++, to, weight);
+            });
+        return;
+    }
+
+    // buckets of consecutive vertices with about total / num_buckets edges
+    uint64_t num_buckets = std::min<uint64_t>(n, 16 * pool.size());
+    std::vector<uint32_t> bucket_of(n);
+    std::vector<uint64_t> bucket_begin(1, 0);
+    for (uint64_t i = 0; i < n; i++) {
+        if (offsets[i] >= (total / num_buckets) * bucket_begin.size() && offsets[i] > offsets[bucket_begin.back()])
+            bucket_begin.push_back(i);
+        bucket_of[i] = bucket_begin.size() - 1;
+    }
+    num_buckets = bucket_begin.size();
+    bucket_begin.push_back(n);
+
+    // count the edges of every block falling in every bucket
+    uint64_t num_blocks = edges.num_blocks();
+    std::vector<uint64_t> counts(num_blocks * num_buckets, 0);
+    pool.parallel_for(0, num_blocks, [&](uint64_t b) {
+        uint64_t *c = counts.data() + b * num_buckets;
+        edges.for_each_edge_in_block(b, [&](uint64_t from, uint64_t, double) { c[bucket_of[from]]++; });
+    }, 1);
+    // start of every (block, bucket) pair: buckets in vertex order, blocks in edge order
+    for (uint64_t k = 0; k < num_buckets; k++) {
+        uint64_t pos = offsets[bucket_begin[k]];
+        for (uint64_t b = 0; b < num_blocks; b++) {
+            uint64_t c = counts[b * num_buckets + k];
+            counts[b * num_buckets + k] = pos;
+            pos += c;
+        }
+    }
+
+    // scatter to the buckets, keeping the edge order
+    std::vector<uint32_t> tmp_from(total), tmp_to(total);
+    std::vector<float> tmp_weight(total);
+    pool.parallel_for(0, num_blocks, [&](uint64_t b) {
+        uint64_t *pos = counts.data() + b * num_buckets;
+        edges.for_each_edge_in_block(b, [&](uint64_t from, uint64_t to, double weight) {
+            uint64_t p = pos[bucket_of[from]]++;
+            tmp_from[p] = (uint32_t)from;
+            tmp_to[p] = (uint32_t)to;
+            tmp_weight[p] = (float)weight;
+        });
+    }, 1);
+
+    // sort every bucket by source vertex
+    pool.parallel_for(0, num_buckets, [&](uint64_t k) {
+        for (uint64_t p = offsets[bucket_begin[k]]; p < offsets[bucket_begin[k + 1]]; p++)
+            emit(cursor[tmp_from[p]]++, tmp_to[p], tmp_weight[p]);
+    }, 1);
+}
+
+// Edge source visiting the out-edges of a graph reversed, by blocks of source vertices:
+// scattering them gives the in-edges of every vertex sorted by source id
+template<typename G>
+class ReversedGraphEdges {
+    G &graph;
+    uint64_t n;
+    uint64_t block_size;
+
+public:
+    ReversedGraphEdges(G &graph, uint64_t n) : graph(graph), n(n), block_size(std::max<uint64_t>(1024, n / (64 * ThreadPool::instance().size()))) {}
+
+    uint64_t num_blocks() const { return (n + block_size - 1) / block_size; }
+
+    template<typename F>
+    void for_each_edge_in_block(uint64_t b, F f) const {
+        for (uint64_t i = b * block_size; i < std::min(n, (b + 1) * block_size); i++)
+            graph.for_each_neighbor(i, [&](uint64_t to, double weight) { f(to, i, weight); });
+    }
+};
+
+#endif //ORACLE_CONTEST_GRAPHBUILDER_H
@@ -0,0 +1,46 @@
+#ifndef ORACLE_CONTEST_GRAPHSELECTOR_H
+#define ORACLE_CONTEST_GRAPHSELECTOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "EdgeList.h"
+
+// Cheap statistics of a loaded graph, computed with one counting pass over the edges
+struct GraphStats {
+    uint64_t vertices;          // distinct vertex ids
+    uint64_t edges;             // directed edges
+    uint64_t max_id;
+    uint64_t max_degree;
+    uint64_t median_degree;     // over the vertices with at least one out-edge
+    double avg_degree;
+    double density;             // edges / (vertices * (vertices - 1))
+    uint64_t dense_threshold;   // vertices with a larger degree would be bitmaps in HybridGraph
+    uint64_t dense_vertices;
+    uint64_t dense_edges;       // edges leaving dense vertices
+    bool weighted;
+    bool undirected;
+};
+
+GraphStats compute_graph_stats(const EdgeList &edges);
+
+// Data structure chosen for a graph ("csr" or "hybrid", as for -G), with the reasons
+struct GraphChoice {
+    std::string type;
+    std::vector<std::string> reasons;
+};
+
+// - most edges leaving vertices denser than the HybridGraph threshold (at least 64), if allow_hybrid:
+//   HybridGraph, whose bitmaps let BFS test 64 neighbors per word (its neighbor order differs,
+//   so the DFS order and the BFS/DFS sums change)
+// - otherwise: CSRGraph, the most compact (weights are not stored for unweighted graphs), with
+//   the same results as AdjacencyList
+// (ids beyond 32 bits are rejected by the EdgeList loader)
+GraphChoice select_graph_type(const GraphStats &stats, bool allow_hybrid);
+
+void print_graph_stats(std::ostream &out, const GraphStats &stats);
+
+void print_graph_choice(std::ostream &out, const GraphChoice &choice);
+
+#endif //ORACLE_CONTEST_GRAPHSELECTOR_H
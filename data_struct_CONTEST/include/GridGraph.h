@@ -0,0 +1,285 @@
+#ifndef ORACLE_CONTEST_GRIDGRAPH_H
+#define ORACLE_CONTEST_GRIDGRAPH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "CSRGraph.h"
+#include "EdgeList.h"
+#include "ReverseIndex.h"
+
+// Grid (2D tiled) implementation of Graph, in the style of GridGraph: vertex ids are split in
+// P ranges of chunk ids, and edge (s, d) is stored in block (s / chunk, d / chunk) of a P x P grid.
+// Each block is a doubly compressed CSR with ids local to its ranges: the sources with edges in
+// the block (sorted), the end of the edges of each one, and the destinations, as 16-bit ids
+// (32-bit if chunk > 65536), plus float weights (not stored for unweighted graphs).
+// chunk is picked so that the dist/used slices of a source range and of a destination range fit
+// in the L2 cache together: kernels walking the blocks of a column (see for_each_block_edge)
+// touch only those. Vertex ids are unchanged; the edges of a vertex keep their order within each
+// block, blocks are visited by destination range (so neighbors are not in file order). Every
+// vertex also lists its rows (block column and row in the block), so that visiting its neighbors
+// costs the blocks it has edges in, not a search in every block of its range.
+// A block holds less than 2^32 edges
+class GridGraph{
+
+    struct Block {
+        uint64_t first_row;     // sources of the block: rows[first_row .. first_row + num_rows)
+        uint64_t num_rows;
+        uint64_t first_edge;    // destinations of the block: dst[first_edge ..), same for weights
+    };
+
+    struct RowRef {
+        uint32_t column;        // block (s / chunk, column)
+        uint32_t row;           // row of s in the block
+    };
+
+    uint64_t v, e;
+    uint64_t chunk;         // ids per range
+    uint64_t P;             // ranges per side of the grid
+    bool wide;              // 32-bit local ids
+    std::vector<Block> blocks;  // block (i, j) at i * P + j
+    char *rows;             // local ids of the sources of each block (uint16_t, or uint32_t if wide)
+    uint32_t *row_ends;     // end of the edges of each source, relative to the first edge of its block
+    char *dst;              // local ids of the destinations (uint16_t, or uint32_t if wide)
+    float *weights;         // nullptr if the graph is unweighted
+    uint32_t *degrees;
+    uint64_t *vertex_offsets;   // rows of vertex s: vertex_rows[vertex_offsets[s] .. vertex_offsets[s + 1]), by column
+    RowRef *vertex_rows;
+    uint64_t num_rows, num_edges;
+    ReverseIndex<uint32_t> in_edges;
+
+    // weights are stored if csr has them
+    void build(const CSRGraph &csr);
+
+    template<typename L>
+    void fill(const CSRGraph &csr);
+
+    template<typename L>
+    void index_rows();
+
+    // edges of the k-th source of block b: dst[begin .. end)
+    inline void row_edges(uint64_t b, uint64_t k, uint64_t &begin, uint64_t &end) const {
+        const Block &block = blocks[b];
+        begin = block.first_edge + (k ? row_ends[block.first_row + k - 1] : 0);
+        end = block.first_edge + row_ends[block.first_row + k];
+    }
+
+    // f(s, d, w) for the edges of the k-th source s of block (i, j)
+    template<typename L, typename F>
+    inline void visit_row(uint64_t b, uint64_t k, uint64_t s, F &f) const {
+        uint64_t begin, end;
+        row_edges(b, k, begin, end);
+        const L *d = (const L *)dst;
+        const uint64_t base = (b % P) * chunk;
+        LOCALITY_ACCESS(ADJACENCY, &row_ends[blocks[b].first_row + k]);
+        if (weights) {
+            for (uint64_t i = begin; i < end; i++) {
+                LOCALITY_ACCESS(ADJACENCY, &d[i]);
+                LOCALITY_ACCESS(WEIGHTS, &weights[i]);
+                f(s, base + d[i], (double)weights[i]);
+            }
+        } else {
+            for (uint64_t i = begin; i < end; i++) {
+                LOCALITY_ACCESS(ADJACENCY, &d[i]);
+                f(s, base + d[i], 1.0);
+            }
+        }
+    }
+
+    // f(s, d, w) for the edges of block (i, j) leaving sources[0 .. count), sorted by id
+    template<typename L, typename F>
+    void visit_block(uint64_t i, uint64_t j, const uint64_t *sources, uint64_t count, F &f) const {
+        const uint64_t b = i * P + j;
+        const Block &block = blocks[b];
+        const L *r = (const L *)rows + block.first_row;
+        const uint64_t n = block.num_rows, base = i * chunk;
+        if (n == 0 || count == 0)
+            return;
+        if (count * 16 < n) {
+            // few sources: find the row of each one in this column among its own rows
+            for (uint64_t k = 0; k < count; k++) {
+                LOCALITY_ACCESS(ADJACENCY, &vertex_offsets[sources[k]]);
+                const RowRef *first = vertex_rows + vertex_offsets[sources[k]], *last = vertex_rows + vertex_offsets[sources[k] + 1];
+                const RowRef *it = std::lower_bound(first, last, j, [](const RowRef &ref, uint64_t column) { return ref.column < column; });
+                if (it < last && it->column == j) {
+                    LOCALITY_ACCESS(ADJACENCY, it);
+                    visit_row<L>(b, it->row, sources[k], f);
+                }
+            }
+        } else {
+            // merge the two sorted lists
+            uint64_t k = 0, row = 0;
+            while (k < count && row < n) {
+                LOCALITY_ACCESS(ADJACENCY, &r[row]);
+                uint64_t s = base + r[row];
+                if (sources[k] < s)
+                    k++;
+                else if (s < sources[k])
+                    row++;
+                else
+                    visit_row<L>(b, row++, sources[k++], f);
+            }
+        }
+    }
+
+    template<typename L, typename F>
+    void visit_all(uint64_t i, uint64_t j, F &f) const {
+        const uint64_t b = i * P + j;
+        const L *r = (const L *)rows + blocks[b].first_row;
+        for (uint64_t k = 0; k < blocks[b].num_rows; k++)
+            visit_row<L>(b, k, i * chunk + r[k], f);
+    }
+
+    template<typename L, typename F>
+    void visit_neighbors(uint64_t idx, F &f) const {
+        const uint64_t first_block = (idx / chunk) * P;
+        LOCALITY_ACCESS(ADJACENCY, &vertex_offsets[idx]);
+        for (uint64_t k = vertex_offsets[idx]; k < vertex_offsets[idx + 1]; k++) {
+            LOCALITY_ACCESS(ADJACENCY, &vertex_rows[k]);
+            visit_row<L>(first_block + vertex_rows[k].column, vertex_rows[k].row, idx, f);
+        }
+    }
+
+public:
+
+    // chunk = 0: largest power of two such that two slices of dist and used fit in the L2 cache
+    GridGraph(uint64_t v, uint64_t e, uint64_t chunk = 0);
+
+    ~GridGraph(){
+        delete[] rows;
+        delete[] row_ends;
+        delete[] dst;
+        delete[] weights;
+        delete[] degrees;
+        delete[] vertex_offsets;
+        delete[] vertex_rows;
+    }
+
+    // resumable walk over the neighbors of a vertex, in the order of for_each_neighbor
+    class NeighborCursor {
+        const GridGraph *graph;
+        const RowRef *row, *row_end;
+        uint64_t first_block, base;     // base: first id of the destination range of the current row
+        uint64_t i, end;                // edges of the current row: dst[i .. end)
+
+    public:
+        NeighborCursor(const GridGraph *graph, uint64_t idx) : graph(graph), row(graph->vertex_rows + graph->vertex_offsets[idx]),
+            row_end(graph->vertex_rows + graph->vertex_offsets[idx + 1]), first_block((idx / graph->chunk) * graph->P), base(0), i(0), end(0) {}
+
+        // next neighbor; false after the last one
+        inline bool next(uint64_t &to, double &weight) {
+            while (i == end) {
+                if (row == row_end)
+                    return false;
+                LOCALITY_ACCESS(ADJACENCY, row);
+                graph->row_edges(first_block + row->column, row->row, i, end);
+                base = row->column * graph->chunk;
+                row++;
+            }
+            if (graph->wide) {
+                LOCALITY_ACCESS(ADJACENCY, &((const uint32_t *)graph->dst)[i]);
+                to = base + ((const uint32_t *)graph->dst)[i];
+            } else {
+                LOCALITY_ACCESS(ADJACENCY, &((const uint16_t *)graph->dst)[i]);
+                to = base + ((const uint16_t *)graph->dst)[i];
+            }
+            if (graph->weights) {
+                LOCALITY_ACCESS(WEIGHTS, &graph->weights[i]);
+                weight = (double)graph->weights[i];
+            } else {
+                weight = 1.0;
+            }
+            i++;
+            return true;
+        }
+    };
+
+    NeighborCursor cursor(uint64_t idx) const {
+        LOCALITY_ACCESS(ADJACENCY, &vertex_offsets[idx]);
+        return NeighborCursor(this, idx);
+    }
+
+    // neighbors of idx, copied (for_each_neighbor does not build them)
+    std::vector<std::pair<uint64_t, double> > get_neighbors(uint64_t idx){
+        std::vector<std::pair<uint64_t, double> > neighbors;
+        for_each_neighbor(idx, [&neighbors](uint64_t to, double weight) { neighbors.push_back(std::make_pair(to, weight)); });
+        return neighbors;
+    }
+
+    // call f(neighbor, weight) for every neighbor of idx, by destination range
+    // (the rows of idx in the blocks it has edges in): not in file order, so the
+    // DFS visiting order differs from the other graph types
+    template<typename F>
+    inline void for_each_neighbor(uint64_t idx, F f) const {
+        auto g = [&f](uint64_t, uint64_t to, double weight) { f(to, weight); };
+        if (wide)
+            visit_neighbors<uint32_t>(idx, g);
+        else
+            visit_neighbors<uint16_t>(idx, g);
+    }
+
+    // call f(source, destination, weight) for the edges of block (i, j) leaving sources[0 .. count)
+    // (sorted by id, all in range i), by source and in storage order
+    template<typename F>
+    inline void for_each_block_edge(uint64_t i, uint64_t j, const uint64_t *sources, uint64_t count, F f) const {
+        if (wide)
+            visit_block<uint32_t>(i, j, sources, count, f);
+        else
+            visit_block<uint16_t>(i, j, sources, count, f);
+    }
+
+    // call f(source, destination, weight) for all the edges of block (i, j)
+    template<typename F>
+    inline void for_each_block_edge(uint64_t i, uint64_t j, F f) const {
+        if (wide)
+            visit_all<uint32_t>(i, j, f);
+        else
+            visit_all<uint16_t>(i, j, f);
+    }
+
+    // ranges per side of the grid, and ids per range: range i is [i * chunk, (i + 1) * chunk)
+    inline uint64_t grid_size() const { return P; }
+
+    inline uint64_t chunk_size() const { return chunk; }
+
+    inline bool is_weighted() const { return weights != nullptr; }
+
+    inline uint64_t degree(uint64_t idx) const { return degrees[idx]; }
+
+    // in-neighbors of idx; the transpose is built on first use
+    ReverseIndex<uint32_t>::EdgeIter get_in_neighbors(uint64_t idx){
+        in_edges.ensure(*this, v + 2);
+        return in_edges.get_neighbors(idx);
+    }
+
+    template<typename F>
+    inline void for_each_in_neighbor(uint64_t idx, F f){
+        in_edges.ensure(*this, v + 2);
+        in_edges.for_each_neighbor(idx, f);
+    }
+
+    inline uint64_t in_degree(uint64_t idx){
+        in_edges.ensure(*this, v + 2);
+        return in_edges.degree(idx);
+    }
+
+    // memory used by the data structure, including the transpose if built
+    uint64_t size_in_bytes() const {
+        uint64_t local = wide ? sizeof(uint32_t) : sizeof(uint16_t);
+        return blocks.size() * sizeof(Block) + num_rows * (local + sizeof(uint32_t) + sizeof(RowRef)) + num_edges * (local + (weights ? sizeof(float) : 0)) +
+            (v + 2) * sizeof(uint32_t) + (v + 3) * sizeof(uint64_t) + in_edges.size_in_bytes();
+    }
+
+    uint64_t reverse_index_size_in_bytes() const { return in_edges.size_in_bytes(); }
+
+    void finished();
+
+    void populate(std::tuple<uint64_t, uint64_t, double>* e_list);
+
+    // build the graph straight from the staged edges (both directions of undirected edges)
+    void populate(const EdgeList &edges);
+};
+
+#endif //ORACLE_CONTEST_GRIDGRAPH_H
@@ -0,0 +1,263 @@
+#ifndef ORACLE_CONTEST_HYBRIDGRAPH_H
+#define ORACLE_CONTEST_HYBRIDGRAPH_H
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "EdgeList.h"
+#include "LocalityProfiler.h"
+#include "ReverseIndex.h"
+
+// Hybrid implementation of Graph: neighbors of low-degree vertices are stored as
+// sorted arrays, neighbors of vertices whose degree exceeds a threshold as bitmaps
+// over all the vertices. Weights are always stored in neighbor id order.
+// Duplicated edges of dense vertices are collapsed (the first weight is kept)
+class HybridGraph{
+
+    class EdgeIter {
+    public:
+        class iterator {
+        public:
+            // sparse vertex: walk the id array
+            iterator(const uint64_t *id_ptr, const double *w_ptr) : id_ptr(id_ptr), words(nullptr), word_idx(0), num_words(0), cur_word(0), w_ptr(w_ptr) {}
+
+            // dense vertex: walk the set bits of the bitmap
+            iterator(const uint64_t *words, uint64_t num_words, const double *w_ptr) : id_ptr(nullptr), words(words), word_idx(0), num_words(num_words), cur_word(num_words ? words[0] : 0), w_ptr(w_ptr) {
+                skip_empty_words();
+            }
+
+            iterator operator++() {
+                ++w_ptr;
+                if (id_ptr)
+                    ++id_ptr;
+                else {
+                    cur_word &= cur_word - 1;
+                    skip_empty_words();
+                }
+                return *this;
+            }
+
+            bool operator!=(const iterator &other) { return w_ptr != other.w_ptr; }
+
+            const std::pair<uint64_t, double> &operator*() {
+                current.first = id_ptr ? *id_ptr : word_idx * 64 + __builtin_ctzll(cur_word);
+                current.second = *w_ptr;
+                return current;
+            };
+
+        private:
+            void skip_empty_words() {
+                while (cur_word == 0 && ++word_idx < num_words)
+                    cur_word = words[word_idx];
+            }
+
+            const uint64_t *id_ptr;
+            const uint64_t *words;
+            uint64_t word_idx, num_words, cur_word;
+            const double *w_ptr;
+            std::pair<uint64_t, double> current;
+        };
+
+    private:
+        iterator begin_it, end_it;
+    public:
+        EdgeIter(iterator begin_it, iterator end_it) : begin_it(begin_it), end_it(end_it) {}
+
+        iterator begin() const { return begin_it; }
+
+        iterator end() const { return end_it; }
+    };
+
+    uint64_t v, e;
+    uint64_t threshold;     // vertices with degree > threshold are stored as bitmaps
+    uint64_t words;         // number of 64-bit words of each bitmap
+    uint64_t num_dense;
+    uint64_t *id_offsets;   // neighbors of sparse vertex i are ids[id_offsets[i]..id_offsets[i+1])
+    uint64_t *ids;
+    uint64_t *w_offsets;    // weights of vertex i are weights[w_offsets[i]..w_offsets[i+1])
+    double *weights;
+    uint32_t *dense_slot;   // bitmap index of dense vertices, NOT_DENSE otherwise
+    uint64_t *bitmaps;
+    ReverseIndex<uint32_t> in_edges;
+
+    static const uint32_t NOT_DENSE = UINT32_MAX;
+
+    template<typename Edges>
+    void build(const Edges &edges);
+
+public:
+
+    // a bitmap costs (v + 2) / 8 bytes, a sorted array 8 bytes per neighbor:
+    // by default vertices are stored as bitmaps when it is cheaper
+    HybridGraph(uint64_t v, uint64_t e, uint64_t threshold = 0) : v(v), e(e), threshold(threshold ? threshold : (v + 2) / 64), words((v + 2 + 63) / 64), num_dense(0),
+        id_offsets(nullptr), ids(nullptr), w_offsets(nullptr), weights(nullptr), dense_slot(nullptr), bitmaps(nullptr) {}
+
+    ~HybridGraph(){
+        delete[] id_offsets;
+        delete[] ids;
+        delete[] w_offsets;
+        delete[] weights;
+        delete[] dense_slot;
+        delete[] bitmaps;
+    }
+
+    EdgeIter get_neighbors(uint64_t idx){
+        const double *w_begin = weights + w_offsets[idx];
+        const double *w_end = weights + w_offsets[idx + 1];
+        if (is_dense(idx)) {
+            const uint64_t *bitmap = dense_bitmap(idx);
+            return EdgeIter(EdgeIter::iterator(bitmap, words, w_begin), EdgeIter::iterator(bitmap, 0, w_end));
+        }
+        return EdgeIter(EdgeIter::iterator(ids + id_offsets[idx], w_begin), EdgeIter::iterator(ids + id_offsets[idx + 1], w_end));
+    }
+
+    // position in the neighbors of a vertex, for visits that stop and resume (e.g. DFS):
+    // the id array of a sparse vertex, or the words of the bitmap of a dense one
+    class NeighborCursor {
+        const uint64_t *ptr, *end;
+        const uint64_t *bitmap;     // nullptr for sparse vertices
+        uint64_t word;              // bits of *ptr not visited yet (dense vertices)
+        const double *w_ptr;
+
+    public:
+        NeighborCursor(const uint64_t *ids, const uint64_t *ids_end, const double *w_ptr) : ptr(ids), end(ids_end), bitmap(nullptr), word(0), w_ptr(w_ptr) {}
+
+        NeighborCursor(const uint64_t *bitmap, uint64_t num_words, const double *w_ptr) : ptr(bitmap), end(bitmap + num_words), bitmap(bitmap), word(num_words ? bitmap[0] : 0), w_ptr(w_ptr) {}
+
+        // next neighbor in id order; false after the last one
+        inline bool next(uint64_t &to, double &weight) {
+            if (!bitmap) {
+                if (ptr == end)
+                    return false;
+                LOCALITY_ACCESS(ADJACENCY, ptr);
+                to = *ptr++;
+            } else {
+                while (word == 0) {
+                    if (++ptr >= end)
+                        return false;
+                    LOCALITY_ACCESS(ADJACENCY, ptr);
+                    word = *ptr;
+                }
+                to = (ptr - bitmap) * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+            }
+            LOCALITY_ACCESS(WEIGHTS, w_ptr);
+            weight = *w_ptr++;
+            return true;
+        }
+    };
+
+    NeighborCursor cursor(uint64_t idx) const {
+        const double *w = weights + w_offsets[idx];
+        if (is_dense(idx))
+            return NeighborCursor(dense_bitmap(idx), words, w);
+        return NeighborCursor(ids + id_offsets[idx], ids + id_offsets[idx + 1], w);
+    }
+
+    // call f(neighbor, weight) for every neighbor of idx, in id order
+    template<typename F>
+    inline void for_each_neighbor(uint64_t idx, F f) const {
+        LOCALITY_ACCESS(WEIGHTS, &w_offsets[idx]);
+        const double *w = weights + w_offsets[idx];
+        if (!is_dense(idx)) {
+            LOCALITY_ACCESS(ADJACENCY, &id_offsets[idx]);
+            for (uint64_t i = id_offsets[idx]; i < id_offsets[idx + 1]; i++) {
+                LOCALITY_ACCESS(ADJACENCY, &ids[i]);
+                LOCALITY_ACCESS(WEIGHTS, w);
+                f(ids[i], *w++);
+            }
+            return;
+        }
+        const uint64_t *bitmap = dense_bitmap(idx);
+        for (uint64_t i = 0; i < words; i++) {
+            LOCALITY_ACCESS(ADJACENCY, &bitmap[i]);
+            for (uint64_t word = bitmap[i]; word; word &= word - 1) {
+                LOCALITY_ACCESS(WEIGHTS, w);
+                f(i * 64 + __builtin_ctzll(word), *w++);
+            }
+        }
+    }
+
+    // visit (in id order) the neighbors of idx that are not set in the visited bitmap,
+    // calling f(neighbor, weight); dense vertices are filtered a word at a time
+    template<typename F>
+    void for_each_unvisited(uint64_t idx, const uint64_t *visited, F f) {
+        LOCALITY_ACCESS(WEIGHTS, &w_offsets[idx]);
+        const double *w = weights + w_offsets[idx];
+        if (!is_dense(idx)) {
+            LOCALITY_ACCESS(ADJACENCY, &id_offsets[idx]);
+            for (uint64_t i = id_offsets[idx]; i < id_offsets[idx + 1]; i++, w++) {
+                LOCALITY_ACCESS(ADJACENCY, &ids[i]);
+                LOCALITY_ACCESS(USED, &visited[ids[i] >> 6]);
+                if (!(visited[ids[i] >> 6] & (1ULL << (ids[i] & 63)))) {
+                    LOCALITY_ACCESS(WEIGHTS, w);
+                    f(ids[i], *w);
+                }
+            }
+            return;
+        }
+        const uint64_t *bitmap = dense_bitmap(idx);
+        uint64_t rank = 0;
+        for (uint64_t i = 0; i < words; i++) {
+            LOCALITY_ACCESS(ADJACENCY, &bitmap[i]);
+            LOCALITY_ACCESS(USED, &visited[i]);
+            uint64_t word = bitmap[i];
+            uint64_t todo = word & ~visited[i];
+            while (todo) {
+                int bit = __builtin_ctzll(todo);
+                LOCALITY_ACCESS(WEIGHTS, &w[rank + __builtin_popcountll(word & ((1ULL << bit) - 1))]);
+                f(i * 64 + bit, w[rank + __builtin_popcountll(word & ((1ULL << bit) - 1))]);
+                todo &= todo - 1;
+            }
+            rank += __builtin_popcountll(word);
+        }
+    }
+
+    inline bool is_dense(uint64_t idx) const { return dense_slot[idx] != NOT_DENSE; }
+
+    inline const uint64_t *dense_bitmap(uint64_t idx) const { return bitmaps + dense_slot[idx] * words; }
+
+    inline uint64_t bitmap_words() const { return words; }
+
+    inline uint64_t num_dense_vertices() const { return num_dense; }
+
+    inline uint64_t degree(uint64_t idx) const { return w_offsets[idx + 1] - w_offsets[idx]; }
+
+    // in-neighbors of idx; the transpose is built on first use
+    ReverseIndex<uint32_t>::EdgeIter get_in_neighbors(uint64_t idx){
+        in_edges.ensure(*this, v + 2);
+        return in_edges.get_neighbors(idx);
+    }
+
+    template<typename F>
+    inline void for_each_in_neighbor(uint64_t idx, F f){
+        in_edges.ensure(*this, v + 2);
+        in_edges.for_each_neighbor(idx, f);
+    }
+
+    inline uint64_t in_degree(uint64_t idx){
+        in_edges.ensure(*this, v + 2);
+        return in_edges.degree(idx);
+    }
+
+    // memory used by the data structure, including the transpose if built
+    uint64_t size_in_bytes() const {
+        return (v + 2) * (2 * sizeof(uint64_t) + sizeof(uint32_t)) + id_offsets[v + 2] * sizeof(uint64_t) +
+            w_offsets[v + 2] * sizeof(double) + num_dense * words * sizeof(uint64_t) + in_edges.size_in_bytes();
+    }
+
+    uint64_t reverse_index_size_in_bytes() const { return in_edges.size_in_bytes(); }
+
+    void sortEdgesByNodeId();
+
+    void finished();
+
+    void populate(std::tuple<uint64_t, uint64_t, double>* e_list);
+
+    // build the graph straight from the staged edges (both directions of undirected edges)
+    void populate(const EdgeList &edges);
+};
+
+
+#endif //ORACLE_CONTEST_HYBRIDGRAPH_H
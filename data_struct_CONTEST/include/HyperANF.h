@@ -0,0 +1,158 @@
+#ifndef ORACLE_CONTEST_HYPERANF_H
+#define ORACLE_CONTEST_HYPERANF_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Approximate neighborhood function with HyperANF (Boldi, Rosa and Vigna): every vertex v keeps a
+// HyperLogLog counter of the vertices that reach v within t hops, starting from v alone; at
+// iteration t the counter of v becomes the union (register-wise max) of its own and those of
+// its in-neighbors at iteration t - 1, so that a pass over the edges per iteration gives
+//   N(t) = number of pairs (x, y) with d(x, y) <= t
+// as the sum of the counters, until no counter changes. From N come the distance distribution
+// and the effective diameter; the harmonic centrality of v, the sum over x of 1 / d(x, v), is
+// the sum over t of (|c_t(v)| - |c_t-1(v)|) / t. Estimates are unbiased up to the HyperLogLog
+// error of each counter (relative standard error 1.04 / sqrt(registers)).
+// Works on any graph type with degree and for_each_neighbor; the unions along the edges are
+// computed by a gather functor, gather(prev, next) doing next[v] |= prev[u] for every edge u -> v
+// (see union_in_edges for the pull over the transpose). Vertex slots without edges in either
+// direction are not vertices of the graph (empty counters).
+
+// HyperLogLog counters of n vertices, with 2^log2m one-byte registers each, stored contiguously
+// (with 64 registers, a counter is a cache line)
+class HyperLogLogCounters {
+    unsigned log2m;
+    uint64_t m;
+    std::vector<uint8_t> registers;
+
+public:
+    HyperLogLogCounters(uint64_t n, unsigned log2m) : log2m(log2m), m(1ULL << log2m), registers(n << log2m, 0) {}
+
+    uint64_t registers_per_counter() const { return m; }
+
+    uint8_t *operator[](uint64_t x) { return registers.data() + (x << log2m); }
+
+    const uint8_t *operator[](uint64_t x) const { return registers.data() + (x << log2m); }
+
+    // add item to the counter of x, hashing it with seed
+    void add(uint64_t x, uint64_t item, uint64_t seed);
+
+    // estimated number of distinct items in the counter of x
+    double estimate(uint64_t x) const;
+
+    // register-wise max of the m registers of to and from, into to: 16 registers per SSE2 instruction
+    static inline void merge(uint8_t *to, const uint8_t *from, uint64_t m) {
+        uint64_t j = 0;
+#ifdef __SSE2__
+        for (; j + 16 <= m; j += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(to + j)), b = _mm_loadu_si128((const __m128i *)(from + j));
+            _mm_storeu_si128((__m128i *)(to + j), _mm_max_epu8(a, b));
+        }
+#endif
+        for (; j < m; j++)
+            to[j] = to[j] > from[j] ? to[j] : from[j];
+    }
+
+    void swap(HyperLogLogCounters &other) { registers.swap(other.registers); }
+};
+
+// neighborhood function estimated by hyper_anf
+struct NeighborhoodFunction {
+    // within[t] = estimated number of pairs (x, y) with d(x, y) <= t (within[0]: the vertices);
+    // the last entry is the number of reachable pairs
+    std::vector<double> within;
+
+    // estimated pairs at distance exactly t
+    double pairs(uint64_t t) const { return t ? within[t] - within[t - 1] : within[0]; }
+
+    // largest distance with pairs (a lower bound of the diameter)
+    uint64_t diameter() const { return within.size() - 1; }
+
+    // distance within which fraction of the reachable pairs lie, linearly interpolated between
+    // consecutive distances
+    double effective_diameter(double fraction = 0.9) const;
+
+    // average distance of the reachable pairs at distance > 0
+    double average_distance() const;
+
+    // write "distance pairs within" lines; false on errors
+    bool write(const std::string &filename) const;
+};
+
+// pull: every vertex merges the counters of its in-neighbors (the transpose is built on first use)
+template<typename G>
+void union_in_edges(G &graph, uint64_t n, const HyperLogLogCounters &prev, HyperLogLogCounters &next) {
+    if (n > 0)
+        graph.in_degree(0);
+    const uint64_t m = prev.registers_per_counter();
+    ThreadPool::instance().parallel_for(0, n, [&](uint64_t x) {
+        uint8_t *counter = next[x];
+        graph.for_each_in_neighbor(x, [&](uint64_t u, double) { HyperLogLogCounters::merge(counter, prev[u], m); });
+    });
+}
+
+// harmonic[i] = estimated harmonic centrality of vertex i, for i in [0, n), with 2^log2m
+// registers per counter and vertex ids hashed with seed; stops after max_distance iterations
+// (0: when no counter changes). Returns the neighborhood function
+template<typename G, typename Gather>
+NeighborhoodFunction hyper_anf(G &graph, uint64_t n, unsigned log2m, uint64_t seed, uint64_t max_distance,
+                               double *harmonic, Gather gather) {
+    ThreadPool &pool = ThreadPool::instance();
+    auto plus = [](double a, double b) { return a + b; };
+    const uint64_t m = 1ULL << log2m;
+    HyperLogLogCounters prev(n, log2m), next(n, log2m);
+    std::vector<uint8_t> exists(n, 0);
+    std::vector<double> size(n, 0);
+    NeighborhoodFunction anf;
+
+    pool.parallel_for(0, n, [&](uint64_t x) {
+        if (graph.degree(x) > 0)
+            __atomic_store_n(&exists[x], 1, __ATOMIC_RELAXED);
+        graph.for_each_neighbor(x, [&](uint64_t to, double) { __atomic_store_n(&exists[to], 1, __ATOMIC_RELAXED); });
+    });
+    pool.parallel_for(0, n, [&](uint64_t x) {
+        harmonic[x] = 0;
+        if (exists[x]) {
+            prev.add(x, x, seed);
+            size[x] = prev.estimate(x);
+        }
+    });
+    auto total = [&]() {
+        return pool.parallel_reduce(0, n, 0.0, [&](uint64_t lo, uint64_t hi) {
+            double sum = 0;
+            for (uint64_t x = lo; x < hi; x++)
+                sum += size[x];
+            return sum;
+        }, plus);
+    };
+    anf.within.push_back(total());
+
+    for (uint64_t t = 1; max_distance == 0 || t <= max_distance; t++) {
+        pool.parallel_for_range(0, n, [&](uint64_t lo, uint64_t hi) { memcpy(next[lo], prev[lo], (hi - lo) * m); });
+        gather(prev, next);
+        double changed = pool.parallel_reduce(0, n, 0.0, [&](uint64_t lo, uint64_t hi) {
+            double count = 0;
+            for (uint64_t x = lo; x < hi; x++)
+                if (memcmp(next[x], prev[x], m) != 0) {
+                    double estimate = next.estimate(x);
+                    harmonic[x] += (estimate - size[x]) / t;
+                    size[x] = estimate;
+                    count++;
+                }
+            return count;
+        }, plus);
+        if (changed == 0)
+            break;
+        anf.within.push_back(total());
+        prev.swap(next);
+    }
+    return anf;
+}
+
+#endif //ORACLE_CONTEST_HYPERANF_H
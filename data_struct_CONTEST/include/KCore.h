@@ -0,0 +1,76 @@
+#ifndef ORACLE_CONTEST_KCORE_H
+#define ORACLE_CONTEST_KCORE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "ThreadPool.h"
+
+// Parallel k-core decomposition by peeling: the degree of a vertex is its out-degree, and removing
+// a vertex decrements the degree of its in-neighbors (for undirected graphs, the usual k-core;
+// for directed ones, the largest k such that the vertex survives in a subgraph where every vertex
+// keeps at least k out-neighbors). Works on any graph type with degree, for_each_in_neighbor.
+//
+// Peeling proceeds by buckets of degree: the bucket of the current level k holds the remaining
+// vertices with degree <= k; all of them are removed in parallel with core number k, and the
+// neighbors whose degree drops to k (a single crossing per vertex, claimed with an atomic
+// decrement) form the next bucket of the same level. When it is empty, k is raised to the
+// smallest remaining degree.
+
+// core[i] = core number of vertex i, for i in [0, n); returns the largest core number
+template<typename G>
+uint64_t core_numbers(G &graph, uint64_t n, uint64_t *core) {
+    ThreadPool &pool = ThreadPool::instance();
+    std::vector<uint64_t> deg(n);
+    std::vector<uint8_t> removed(n, 0);
+    std::mutex mutex;
+
+    // build the transpose before going parallel
+    if (n > 0)
+        graph.in_degree(0);
+    pool.parallel_for(0, n, [&](uint64_t i) { deg[i] = graph.degree(i); });
+
+    std::vector<uint64_t> remaining(n), bucket, next;
+    for (uint64_t i = 0; i < n; i++)
+        remaining[i] = i;
+    uint64_t k = 0;
+    while (true) {
+        // drop the removed vertices and move to the smallest remaining degree
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](uint64_t x) { return removed[x] != 0; }), remaining.end());
+        if (remaining.empty())
+            break;
+        k = std::max(k, pool.parallel_reduce(0, remaining.size(), (uint64_t)UINT64_MAX, [&](uint64_t lo, uint64_t hi) {
+            uint64_t smallest = UINT64_MAX;
+            for (uint64_t i = lo; i < hi; i++)
+                smallest = std::min(smallest, deg[remaining[i]]);
+            return smallest;
+        }, [](uint64_t a, uint64_t b) { return std::min(a, b); }));
+
+        bucket.clear();
+        for (uint64_t x : remaining)
+            if (deg[x] <= k)
+                bucket.push_back(x);
+        while (!bucket.empty()) {
+            pool.parallel_for(0, bucket.size(), [&](uint64_t i) {
+                removed[bucket[i]] = 1;
+                core[bucket[i]] = k;
+            });
+            next.clear();
+            pool.parallel_for_range(0, bucket.size(), [&](uint64_t lo, uint64_t hi) {
+                std::vector<uint64_t> local;
+                for (uint64_t i = lo; i < hi; i++)
+                    graph.for_each_in_neighbor(bucket[i], [&](uint64_t y, double) {
+                        if (!removed[y] && __atomic_fetch_sub(&deg[y], 1, __ATOMIC_RELAXED) == k + 1)
+                            local.push_back(y);
+                    });
+                std::lock_guard<std::mutex> lock(mutex);
+                next.insert(next.end(), local.begin(), local.end());
+            });
+            bucket.swap(next);
+        }
+    }
+    return k;
+}
+
+#endif //ORACLE_CONTEST_KCORE_H
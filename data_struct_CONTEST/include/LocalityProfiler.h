@@ -0,0 +1,135 @@
+#ifndef ORACLE_CONTEST_LOCALITYPROFILER_H
+#define ORACLE_CONTEST_LOCALITYPROFILER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Memory-access locality of a traversal, recorded by the instrumentation build (make profile,
+// which defines LOCALITY_PROFILE): the traversals of GraphAlgorithm and the neighbor visitors of
+// the graph types report the addresses they touch through the LOCALITY_* macros below, which
+// compile to nothing in the normal build. For each stream of accesses (used/visited flags,
+// dist, neighbor ids, weights, and all of them interleaved) the profiler reports
+// - the fraction of accesses to the same cache line / page as the previous access of the stream;
+// - the histogram of reuse distances, i.e. the number of distinct cache lines accessed since the
+//   previous access to the same line (a fully associative LRU cache of C lines hits the accesses
+//   with reuse distance < C);
+// - the working set (distinct lines and pages) of every BFS level.
+// Reuse distances and working sets are estimated on a sample of the lines and pages, picked by
+// hashing their address (1 in period), and scaled back.
+
+enum class LocalityStream {
+    USED,       // used / visited flags
+    DIST,
+    ADJACENCY,  // offsets and neighbor ids (or bitmaps)
+    WEIGHTS,
+};
+
+// Reuse distances of the sampled lines of a stream: a Fenwick tree over the access times
+// holds a 1 at the last access of every line, so the distinct lines accessed since time t
+// are the ones after t
+class ReuseTracker {
+    uint64_t time;
+    std::unordered_map<uint64_t, uint64_t> last;   // line -> time of its last access
+    std::vector<int64_t> tree;
+    std::vector<uint8_t> marks;
+
+    void add(uint64_t t, int64_t delta);
+
+    // 1s in [0, t)
+    uint64_t prefix(uint64_t t) const;
+
+public:
+    // histogram[0]: reuse distance 0, histogram[b]: [2^(b-1), 2^b) lines (after scaling)
+    std::vector<uint64_t> histogram;
+    uint64_t cold;      // first accesses
+
+    ReuseTracker() : time(0), cold(0) {}
+
+    // access to a sampled line; scale is the sampling period
+    void access(uint64_t line, uint64_t scale);
+};
+
+// Working set of a BFS level
+struct LocalityLevel {
+    uint64_t accesses;
+    uint64_t lines[5];  // distinct lines per stream (USED, DIST, ADJACENCY, WEIGHTS) and overall
+    uint64_t pages;
+};
+
+class LocalityProfiler {
+public:
+    static const unsigned STREAMS = 4;
+    static const uint64_t LINE = 64, PAGE = 4096;
+
+private:
+    std::string name;
+    uint64_t line_period, page_period;
+    uint64_t accesses[STREAMS + 1], same_line[STREAMS + 1], same_page[STREAMS + 1];
+    uint64_t previous[STREAMS + 1];     // last address of every stream
+    ReuseTracker reuse[STREAMS + 1];
+    std::vector<LocalityLevel> levels;
+    uint64_t cur_level;
+    std::unordered_set<uint64_t> level_lines[STREAMS + 1], level_pages;
+
+    void close_level();
+
+public:
+    // profiler of the traversal running on this thread (see LocalityScope)
+    static thread_local LocalityProfiler *active;
+
+    LocalityProfiler() : line_period(1), page_period(1), cur_level(0) { start("", 0); }
+
+    // forget the previous profile; footprint (bytes of the accessed data) sets the sampling periods
+    void start(const std::string &traversal, uint64_t footprint);
+
+    void access(LocalityStream stream, const void *address);
+
+    // the next accesses belong to BFS level l
+    void level(uint64_t l);
+
+    void stop();
+
+    // true if no access was recorded (e.g. in the normal build)
+    bool empty() const { return accesses[STREAMS] == 0; }
+
+    const std::string &traversal() const { return name; }
+
+    // write the profile as CSV sections (streams, reuse histograms, levels); false on errors
+    bool write(const std::string &filename) const;
+
+    // short summary: locality per stream and hit rate of LRU caches of 32 KB, 1 MB and 32 MB
+    void print(std::ostream &out) const;
+};
+
+// records the accesses of this thread in profiler for its lifetime
+class LocalityScope {
+    LocalityProfiler &profiler;
+    LocalityProfiler *previous;
+
+public:
+    LocalityScope(LocalityProfiler &profiler, const std::string &traversal, uint64_t footprint) : profiler(profiler), previous(LocalityProfiler::active) {
+        profiler.start(traversal, footprint);
+        LocalityProfiler::active = &profiler;
+    }
+
+    ~LocalityScope() {
+        profiler.stop();
+        LocalityProfiler::active = previous;
+    }
+};
+
+#ifdef LOCALITY_PROFILE
+#define LOCALITY_SCOPE(profiler, traversal, footprint) LocalityScope locality_scope(profiler, traversal, footprint)
+#define LOCALITY_ACCESS(stream, address) do { if (LocalityProfiler::active) LocalityProfiler::active->access(LocalityStream::stream, address); } while (0)
+#define LOCALITY_LEVEL(l) do { if (LocalityProfiler::active) LocalityProfiler::active->level(l); } while (0)
+#else
+#define LOCALITY_SCOPE(profiler, traversal, footprint) do {} while (0)
+#define LOCALITY_ACCESS(stream, address) do {} while (0)
+#define LOCALITY_LEVEL(l) do {} while (0)
+#endif
+
+#endif //ORACLE_CONTEST_LOCALITYPROFILER_H
@@ -0,0 +1,117 @@
+#ifndef ORACLE_CONTEST_LOUVAIN_H
+#define ORACLE_CONTEST_LOUVAIN_H
+
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+
+// Community detection maximizing modularity with the Louvain method, on the graph taken as
+// undirected and weighted: the weight between u and v is the sum of the weights of the edges
+// u -> v and v -> u (for graphs loaded as undirected, the weight of the edge). Modularity is
+//   Q = sum over the communities c of  in(c) / 2m - (tot(c) / 2m)^2
+// where in(c) is the weight of the edges inside c (both directions), tot(c) the weighted degree
+// of its vertices, and 2m the weighted degree of the graph. Works on any graph type with
+// for_each_neighbor (and for_each_in_neighbor, for directed graphs).
+//
+// Every level moves vertices between the communities of their neighbors (local moving), then
+// merges every community into a vertex of the graph of the next level (coarsening), until a
+// level does not raise modularity by threshold. Local moving runs in sweeps over the vertices,
+// each split in LOUVAIN_BATCHES batches of consecutive ids: the vertices of a batch evaluate in
+// parallel (each range in its own scratch) the gain of joining every community of their
+// neighbors, then the moves of the batch are applied before the next one, so that later
+// batches see them (fully synchronous sweeps let neighbors move at once on stale communities,
+// and lose much of the modularity of the sequential method). A singleton only moves to a
+// singleton with a smaller id, so that pairs do not swap. Sweeps stop when modularity rises by
+// less than threshold (a sweep lowering it is undone). Coarsening groups the vertices by
+// community with the counting sort of the graph builders, then builds the rows of the
+// communities in parallel. Moves do not depend on the number of threads.
+
+static const uint64_t LOUVAIN_BATCHES = 256;
+
+// Symmetric weighted graph of a level: the neighbors of vertex i are ids[offsets[i]..offsets[i+1]),
+// with weights summed in double precision; a community merged into a vertex keeps the weight
+// of its inner edges as a self-loop. degree[i] is the sum of the weights of row i
+struct LouvainLevel {
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> ids;
+    std::vector<double> weights;
+    std::vector<double> degree;
+
+    uint64_t size() const { return offsets.size() - 1; }
+};
+
+// modularity of the partition comm of g, given the weighted degree tot of every community
+double louvain_modularity(const LouvainLevel &g, const std::vector<uint32_t> &comm, const std::vector<double> &tot);
+
+// local moving on g from singletons: comm[i] = community of vertex i, renumbered in [0, result)
+// in order of their smallest vertex; modularity is set to the one of comm
+uint64_t louvain_move(const LouvainLevel &g, double threshold, std::vector<uint32_t> &comm, double &modularity);
+
+// graph of the next level, with community c of comm (in [0, communities)) as vertex c
+LouvainLevel louvain_coarsen(const LouvainLevel &g, const std::vector<uint32_t> &comm, uint64_t communities);
+
+// level 0: the rows of the n vertices of graph, out-edges followed by in-edges unless undirected
+template<typename G>
+LouvainLevel louvain_input(G &graph, uint64_t n, bool undirected) {
+    ThreadPool &pool = ThreadPool::instance();
+    LouvainLevel g;
+    g.offsets.assign(n + 1, 0);
+    // build the transpose before going parallel
+    if (!undirected && n > 0)
+        graph.in_degree(0);
+    pool.parallel_for(0, n, [&](uint64_t x) { g.offsets[x + 1] = graph.degree(x) + (undirected ? 0 : graph.in_degree(x)); });
+    for (uint64_t x = 0; x < n; x++)
+        g.offsets[x + 1] += g.offsets[x];
+    g.ids.resize(g.offsets[n]);
+    g.weights.resize(g.offsets[n]);
+    g.degree.resize(n);
+    pool.parallel_for(0, n, [&](uint64_t x) {
+        uint64_t p = g.offsets[x];
+        double degree = 0;
+        auto add = [&](uint64_t to, double weight) {
+            g.ids[p] = (uint32_t)to;
+            g.weights[p++] = weight;
+            degree += weight;
+        };
+        graph.for_each_neighbor(x, add);
+        if (!undirected)
+            graph.for_each_in_neighbor(x, add);
+        g.degree[x] = degree;
+    });
+    return g;
+}
+
+// community[i] = community of vertex i for i in [0, n), labeled by its smallest vertex; levels is
+// set to the number of levels that moved vertices. Returns the modularity of the communities
+template<typename G>
+double louvain_communities(G &graph, uint64_t n, bool undirected, double threshold, uint64_t *community, uint64_t &levels) {
+    ThreadPool &pool = ThreadPool::instance();
+    LouvainLevel g = louvain_input(graph, n, undirected);
+    // vertex of the current level holding each vertex of the graph
+    std::vector<uint32_t> vertex(n), comm;
+    pool.parallel_for(0, n, [&](uint64_t x) { vertex[x] = (uint32_t)x; });
+
+    double modularity = louvain_modularity(g, vertex, g.degree);
+    levels = 0;
+    while (true) {
+        double previous = modularity;
+        uint64_t communities = louvain_move(g, threshold, comm, modularity);
+        if (communities == g.size())
+            break;
+        pool.parallel_for(0, n, [&](uint64_t x) { vertex[x] = comm[vertex[x]]; });
+        levels++;
+        if (modularity - previous < threshold)
+            break;
+        g = louvain_coarsen(g, comm, communities);
+    }
+
+    // label every community by its smallest vertex
+    std::vector<uint64_t> label(g.size(), UINT64_MAX);
+    for (uint64_t x = 0; x < n; x++)
+        if (label[vertex[x]] == UINT64_MAX)
+            label[vertex[x]] = x;
+    pool.parallel_for(0, n, [&](uint64_t x) { community[x] = label[vertex[x]]; });
+    return modularity;
+}
+
+#endif //ORACLE_CONTEST_LOUVAIN_H
@@ -0,0 +1,45 @@
+#ifndef ORACLE_CONTEST_NEIGHBORSPAN_H
+#define ORACLE_CONTEST_NEIGHBORSPAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-only view over a contiguous array, [first, last)
+template<typename T>
+class Span {
+    const T *first, *last;
+
+public:
+    Span() : first(nullptr), last(nullptr) {}
+
+    Span(const T *first, const T *last) : first(first), last(last) {}
+
+    const T *begin() const { return first; }
+
+    const T *end() const { return last; }
+
+    const T *data() const { return first; }
+
+    size_t size() const { return last - first; }
+
+    bool empty() const { return first == last; }
+
+    const T &operator[](size_t i) const { return first[i]; }
+};
+
+// Neighbors of a vertex in a contiguous graph type, pointing straight into its arrays:
+// ids[i] is the i-th neighbor and weights[i] its weight. weights is empty when the graph
+// is unweighted, in which case every edge weighs 1 (as assigned by the loader)
+template<typename Id>
+struct NeighborSpan {
+    Span<Id> ids;
+    Span<float> weights;
+
+    NeighborSpan(Span<Id> ids, Span<float> weights) : ids(ids), weights(weights) {}
+
+    size_t size() const { return ids.size(); }
+
+    double weight(size_t i) const { return weights.empty() ? 1.0 : weights[i]; }
+};
+
+#endif //ORACLE_CONTEST_NEIGHBORSPAN_H
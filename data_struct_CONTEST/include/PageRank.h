@@ -0,0 +1,88 @@
+#ifndef ORACLE_CONTEST_PAGERANK_H
+#define ORACLE_CONTEST_PAGERANK_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+
+// PageRank as specified by LDBC Graphalytics: starting from 1 / N on the N vertices of the graph,
+// every iteration computes
+//   pr'[v] = (1 - d) / N + d * (sum over in-neighbors u of pr[u] / outdeg(u) + dangling / N)
+// where dangling is the rank of the vertices without out-edges, spread over all the vertices.
+// Vertex slots without edges in either direction are not vertices of the graph (rank 0).
+// Works on any graph type with degree; the sums over the in-edges are computed by a gather
+// functor, gather(contrib, sums) setting sums[v] to the sum of contrib[u] over the edges u -> v
+// (see gather_in_edges for the pull over the transpose). Every step is a parallel loop or a
+// deterministic parallel_reduce on the ThreadPool.
+
+// pull: every vertex sums the contributions of its in-neighbors (the transpose is built on first use)
+template<typename G>
+void gather_in_edges(G &graph, uint64_t n, const double *contrib, double *sums) {
+    if (n > 0)
+        graph.in_degree(0);
+    ThreadPool::instance().parallel_for(0, n, [&](uint64_t x) {
+        double sum = 0;
+        graph.for_each_in_neighbor(x, [&](uint64_t u, double) { sum += contrib[u]; });
+        sums[x] = sum;
+    });
+}
+
+// pr[i] = rank of vertex i, for i in [0, n), after max_iterations iterations or as soon as the
+// L1 change of an iteration is below epsilon (0: never); delta is the last change.
+// Returns the number of iterations run
+template<typename G, typename Gather>
+uint64_t page_rank(G &graph, uint64_t n, double damping, uint64_t max_iterations, double epsilon,
+                   double *pr, Gather gather, double &delta) {
+    ThreadPool &pool = ThreadPool::instance();
+    auto plus = [](double a, double b) { return a + b; };
+    std::vector<double> inv_degree(n), contrib(n, 1), sums(n);
+    std::vector<uint8_t> exists(n), dangling(n);
+
+    // in-degrees, with a gather of ones
+    gather(contrib.data(), sums.data());
+    pool.parallel_for(0, n, [&](uint64_t x) {
+        uint64_t deg = graph.degree(x);
+        inv_degree[x] = deg ? 1.0 / deg : 0;
+        exists[x] = deg > 0 || sums[x] > 0;
+        dangling[x] = exists[x] && deg == 0;
+    });
+    double vertices = pool.parallel_reduce(0, n, 0.0, [&](uint64_t lo, uint64_t hi) {
+        double count = 0;
+        for (uint64_t x = lo; x < hi; x++)
+            count += exists[x];
+        return count;
+    }, plus);
+    pool.parallel_for(0, n, [&](uint64_t x) { pr[x] = exists[x] ? 1 / vertices : 0; });
+
+    delta = 0;
+    uint64_t iteration = 0;
+    while (iteration < max_iterations) {
+        pool.parallel_for(0, n, [&](uint64_t x) { contrib[x] = pr[x] * inv_degree[x]; });
+        double lost = pool.parallel_reduce(0, n, 0.0, [&](uint64_t lo, uint64_t hi) {
+            double sum = 0;
+            for (uint64_t x = lo; x < hi; x++)
+                sum += dangling[x] ? pr[x] : 0;
+            return sum;
+        }, plus);
+        gather(contrib.data(), sums.data());
+
+        const double base = (1 - damping) / vertices + damping * lost / vertices;
+        delta = pool.parallel_reduce(0, n, 0.0, [&](uint64_t lo, uint64_t hi) {
+            double change = 0;
+            for (uint64_t x = lo; x < hi; x++) {
+                double rank = exists[x] ? base + damping * sums[x] : 0;
+                change += std::fabs(rank - pr[x]);
+                pr[x] = rank;
+            }
+            return change;
+        }, plus);
+        iteration++;
+        if (delta < epsilon)
+            break;
+    }
+    return iteration;
+}
+
+#endif //ORACLE_CONTEST_PAGERANK_H
@@ -0,0 +1,91 @@
+#ifndef ORACLE_CONTEST_PARTITIONEDBFS_H
+#define ORACLE_CONTEST_PARTITIONEDBFS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "EdgeList.h"
+
+// POSIX shared memory object, mapped in the creating process and inherited by its children
+class SharedMemory {
+    std::string name;
+    uint64_t size;
+    void *base;
+
+public:
+    SharedMemory() : size(0), base(nullptr) {}
+
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    // create, size and map the object /name; returns false (after printing an error) on failure
+    bool create(const std::string &name, uint64_t size);
+
+    char *data() const { return (char *)base; }
+};
+
+// Communication of one BFS level
+struct LevelStats {
+    uint64_t frontier;  // vertices expanded in the level
+    uint64_t messages;  // frontier candidates sent to other partitions
+    uint64_t bytes;
+};
+
+// Level-synchronous BFS over a graph 1D-partitioned by vertex range across num_procs processes,
+// as in a distributed BFS, but with the partitions in POSIX shared memory on one box.
+// Each process owns vertices [p * chunk, (p + 1) * chunk), the rows of a CSR in shared memory,
+// and the distances of its vertices. At every level it expands its frontier, appends the
+// neighbors owned by other processes to their mailboxes (at most once per target vertex),
+// then, after a process-shared barrier, reads its own mailboxes to build the next frontier.
+// A vertex is reached from its smallest parent in the previous level (first edge of the parent
+// to it), so distances and weight sum do not depend on the number of processes.
+class PartitionedBFS {
+    uint64_t n, m;
+    unsigned num_procs;
+    uint64_t chunk;
+    SharedMemory graph_shm, exchange_shm;
+    // graph segment
+    uint64_t *offsets;
+    uint32_t *ids;
+    float *weights;
+    uint64_t *dist;
+    // exchange segment (see PartitionedBFS.cpp)
+    struct Exchange;
+    struct Message;
+    Exchange *exchange;
+    uint64_t *box_begin, *box_count;   // mailbox of (sender p, receiver q) at p * num_procs + q
+    uint64_t *received, *frontier_size;
+    double *partial_sum;
+    Message *messages;
+    LevelStats *stats;
+    std::vector<LevelStats> levels;
+
+    void run_process(unsigned p, uint64_t source);
+
+public:
+    // copy the graph (vertex ids in [0, num_vertices)) into shared memory, partitioned across num_procs
+    PartitionedBFS(const EdgeList &edges, uint64_t num_vertices, unsigned num_procs);
+
+    ~PartitionedBFS();
+
+    // false if the shared memory could not be set up
+    bool ready() const { return exchange != nullptr; }
+
+    // run the BFS from source in num_procs forked processes; false on errors.
+    // sum is the weight sum of the BFS tree
+    bool bfs(uint64_t source, double &sum);
+
+    // distance of every vertex from the last source (LONG_MAX if unreached)
+    const uint64_t *distances() const { return dist; }
+
+    // communication per level of the last BFS
+    const std::vector<LevelStats> &level_stats() const { return levels; }
+
+    unsigned processes() const { return num_procs; }
+
+    inline unsigned owner(uint64_t x) const { return x / chunk; }
+};
+
+#endif //ORACLE_CONTEST_PARTITIONEDBFS_H
@@ -0,0 +1,302 @@
+#ifndef ORACLE_CONTEST_QUERYSERVER_H
+#define ORACLE_CONTEST_QUERYSERVER_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "GraphAlgorithm.h"
+#include "ResultWriter.h"
+#include "ThreadPool.h"
+#include "TraversalState.h"
+#include "VersionedGraph.h"
+
+// detects graph types that publish versions (see VersionedGraph)
+template<typename T>
+class has_snapshots {
+    template<typename U> static char test(decltype(&U::snapshot));
+    template<typename U> static long test(...);
+public:
+    static const bool value = sizeof(test<T>(0)) == sizeof(char);
+};
+
+// Reads newline-terminated lines from a file descriptor
+class LineReader {
+    int fd;
+    std::vector<char> buffer;
+    size_t begin, end;
+
+public:
+    explicit LineReader(int fd) : fd(fd), buffer(1 << 16), begin(0), end(0) {}
+
+    // false at end of input
+    bool next(std::string &line);
+};
+
+// write a whole line (a '\n' is appended) to fd; false on error
+bool write_line(int fd, const std::string &line);
+
+// listening Unix domain socket bound to path (replacing a stale one), only accessible by the
+// owner of the process; -1 on error
+int listen_unix(const std::string &path);
+
+// whether a result file name sent by a client is a plain name (no '/' nor "..")
+bool valid_result_name(const std::string &name);
+
+// Long-running server answering traversal queries on a graph built once.
+// Queries are read one per line, from stdin or from the connections to a Unix domain socket:
+//   bfs <src> [file]        BFS from src
+//   dfs <src> [file]        DFS from src
+//   khop <src> <k> [file]   vertices within k hops from src
+//   distance <src> <dst>    number of hops from src to dst (bidirectional BFS)
+//   add <src> <dst> [w]     queue an edge for the next commit of this connection (no answer);
+//                           on an undirected graph, both directions are added
+//   commit                  add the queued edges to the graph as a new version
+//   quit                    close the connection (end of input does the same)
+//   shutdown                stop the socket server
+// If file is given, the per-vertex results are written there, like the .bfs/.dfs files; it must be
+// a plain file name, created in the output directory of the server.
+// Queries run concurrently on the ThreadPool, each with its own TraversalState, so answers
+// may come out of order; each answer is a CSV line
+//   seq,query,src,reached,value,latency_us
+// where seq is the line number of the query in its connection, reached the number of
+// vertices reached (explored for distance), value the weight sum returned by bfs/dfs or the
+// distance ("-" for khop and unreachable targets), and latency_us the time from the reception
+// of the query to its answer. Bad queries get "seq,ERROR: ...".
+// Updates need a VersionedGraph (-G versioned): every query runs on the snapshot of the graph
+// taken when it is received, so it sees the edges committed before it and none of the later
+// ones, while commits proceed concurrently. A commit is answered with
+//   seq,commit,-,edges,version,latency_us
+// with the number of (directed) edges in the new version of the graph and its number.
+template<typename T>
+class QueryServer {
+    GraphAlgorithm<T> &graph;
+    ResultFormat format;
+    std::string output_dir;
+    bool undirected;
+    std::mutex states_mutex;
+    std::vector<std::unique_ptr<TraversalState> > free_states;
+    std::atomic<bool> stopping;
+    int listen_fd;
+
+    // traversal states are recycled, so that queries do not allocate O(V) memory each
+    std::unique_ptr<TraversalState> acquire_state() {
+        std::lock_guard<std::mutex> lock(states_mutex);
+        if (free_states.empty())
+            return std::unique_ptr<TraversalState>(new TraversalState(graph.num_vertices() + 2));
+        std::unique_ptr<TraversalState> s = std::move(free_states.back());
+        free_states.pop_back();
+        return s;
+    }
+
+    void release_state(std::unique_ptr<TraversalState> s) {
+        std::lock_guard<std::mutex> lock(states_mutex);
+        free_states.push_back(std::move(s));
+    }
+
+    typedef std::integral_constant<bool, has_snapshots<T>::value> versioned;
+    typedef std::vector<std::tuple<uint64_t, uint64_t, double> > Batch;
+
+    // snapshot of the graph for a query received now (nullptr if the graph is not versioned)
+    std::shared_ptr<VersionedGraph::Snapshot> take_snapshot(std::true_type) {
+        return std::make_shared<VersionedGraph::Snapshot>(graph.structure().snapshot());
+    }
+
+    std::shared_ptr<VersionedGraph::Snapshot> take_snapshot(std::false_type) { return nullptr; }
+
+    std::string commit(Batch &batch, uint64_t seq, std::chrono::high_resolution_clock::time_point received, std::true_type) {
+        std::ostringstream out;
+        uint64_t number, edges;
+        if (!graph.structure().apply(batch, &number, &edges)) {
+            out << seq << ",ERROR: commit failed, edge out of the vertex range";
+        } else {
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - received);
+            out << seq << ",commit,-," << edges << "," << number << "," << latency.count();
+        }
+        batch.clear();
+        return out.str();
+    }
+
+    std::string commit(Batch &batch, uint64_t seq, std::chrono::high_resolution_clock::time_point, std::false_type) {
+        batch.clear();
+        return std::to_string(seq) + ",ERROR: updates need a versioned graph (-G versioned)";
+    }
+
+    std::string answer(const std::string &query, uint64_t seq, std::chrono::high_resolution_clock::time_point received) {
+        std::istringstream in(query);
+        std::string kind, file;
+        uint64_t src = 0, k = 0;
+        std::ostringstream out;
+        in >> kind >> src;
+        if (in.fail() || (kind != "bfs" && kind != "dfs" && kind != "khop" && kind != "distance")) {
+            out << seq << ",ERROR: bad query '" << query << "'";
+            return out.str();
+        }
+        if ((kind == "khop" || kind == "distance") && !(in >> k)) {
+            out << seq << ",ERROR: missing " << (kind == "khop" ? "k" : "dst") << " in '" << query << "'";
+            return out.str();
+        }
+        if (kind != "distance")
+            in >> file;
+        if (!file.empty() && !valid_result_name(file)) {
+            out << seq << ",ERROR: bad file name '" << file << "', expected a name without '/' and '..'";
+            return out.str();
+        }
+        if (src > graph.num_vertices() + 1 || (kind == "distance" && k > graph.num_vertices() + 1)) {
+            out << seq << ",ERROR: vertex " << (src > graph.num_vertices() + 1 ? src : k) << " out of range";
+            return out.str();
+        }
+
+        std::unique_ptr<TraversalState> s = acquire_state();
+        double sum = 0;
+        uint64_t reached = 0, hops = LONG_MAX;
+        if (kind == "bfs")
+            sum = graph.bfs(src, *s);
+        else if (kind == "dfs")
+            sum = graph.dfs(src, *s);
+        else if (kind == "khop")
+            reached = graph.khop(src, k, *s);
+        else {
+            hops = graph.distance(src, k, *s);
+            reached = s->touched.size();
+        }
+        if (kind == "bfs" || kind == "dfs")
+            for (uint64_t i = 0; i < s->n; i++)
+                reached += (s->dist[i] != (uint64_t)LONG_MAX);
+        if (!file.empty())
+            ResultWriter(format).write(output_dir + "/" + file, s->dist, graph.num_vertices() + 1);
+        release_state(std::move(s));
+
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - received);
+        out << seq << "," << kind << "," << src << "," << reached << ",";
+        if (kind == "khop" || (kind == "distance" && hops == (uint64_t)LONG_MAX))
+            out << "-";
+        else if (kind == "distance")
+            out << hops;
+        else
+            out << sum;
+        out << "," << latency.count();
+        return out.str();
+    }
+
+    // answer the queries read from in_fd on out_fd, until the end of input or "quit"
+    void serve_connection(int in_fd, int out_fd) {
+        ThreadPool &pool = ThreadPool::instance();
+        LineReader reader(in_fd);
+        std::mutex out_mutex;
+        TaskGroup group;
+        std::string line;
+        uint64_t seq = 0;
+        Batch batch;
+        while (reader.next(line)) {
+            if (line.empty())
+                continue;
+            seq++;
+            if (line == "quit")
+                break;
+            if (line == "shutdown") {
+                stop();
+                break;
+            }
+            auto received = std::chrono::high_resolution_clock::now();
+            if (line.compare(0, 4, "add ") == 0) {
+                std::istringstream in(line.substr(4));
+                uint64_t from, to;
+                double weight = 1;
+                if (in >> from >> to) {
+                    in >> weight;
+                    batch.push_back(std::make_tuple(from, to, weight));
+                    if (undirected && from != to)
+                        batch.push_back(std::make_tuple(to, from, weight));
+                } else {
+                    std::lock_guard<std::mutex> lock(out_mutex);
+                    write_line(out_fd, std::to_string(seq) + ",ERROR: bad update '" + line + "'");
+                }
+                continue;
+            }
+            if (line == "commit") {
+                // the queries received so far hold their snapshots already
+                std::string result = commit(batch, seq, received, versioned());
+                std::lock_guard<std::mutex> lock(out_mutex);
+                write_line(out_fd, result);
+                continue;
+            }
+            std::shared_ptr<VersionedGraph::Snapshot> snapshot = take_snapshot(versioned());
+            auto task = [this, line, seq, received, snapshot, out_fd, &out_mutex]() {
+                VersionedGraph::SnapshotScope scope(snapshot.get());
+                std::string result = answer(line, seq, received);
+                std::lock_guard<std::mutex> lock(out_mutex);
+                write_line(out_fd, result);
+            };
+            // with a single thread there are no workers: answer right away
+            if (pool.size() == 1)
+                task();
+            else
+                pool.spawn(group, task);
+        }
+        pool.wait(group);
+    }
+
+    void stop() {
+        stopping = true;
+        if (listen_fd >= 0)
+            ::shutdown(listen_fd, SHUT_RDWR);
+    }
+
+public:
+    // format: format of the result files written by the queries, output_dir: directory where
+    // they are written, undirected: whether the graph was loaded as undirected (added edges go both ways)
+    QueryServer(GraphAlgorithm<T> &graph, ResultFormat format, const std::string &output_dir, bool undirected)
+        : graph(graph), format(format), output_dir(output_dir), undirected(undirected), stopping(false), listen_fd(-1) {}
+
+    // answer the queries on stdin, writing the answers on stdout
+    void serve_stdin() {
+        serve_connection(STDIN_FILENO, STDOUT_FILENO);
+    }
+
+    // accept connections on a Unix domain socket, each one served by its own thread,
+    // until a client sends "shutdown" (open connections are served until they are closed);
+    // false if the socket cannot be created
+    bool serve_socket(const std::string &path) {
+        listen_fd = listen_unix(path);
+        if (listen_fd < 0)
+            return false;
+        // a client going away must not kill the server
+        signal(SIGPIPE, SIG_IGN);
+        std::vector<std::thread> connections;
+        while (!stopping) {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                if (!stopping)
+                    std::cerr << "ERROR: cannot accept connections on " << path << std::endl;
+                break;
+            }
+            connections.emplace_back([this, fd]() {
+                serve_connection(fd, fd);
+                ::close(fd);
+            });
+        }
+        for (auto &c : connections)
+            c.join();
+        ::close(listen_fd);
+        ::unlink(path.c_str());
+        return true;
+    }
+};
+
+#endif //ORACLE_CONTEST_QUERYSERVER_H
@@ -0,0 +1,57 @@
+#ifndef ORACLE_CONTEST_RESULTWRITER_H
+#define ORACLE_CONTEST_RESULTWRITER_H
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// On-disk formats of the per-vertex result files (.bfs, .dfs, ...)
+// TEXT:       "vertex value" lines, same as the original write_results
+// BINARY:     8-byte magic, number of values, raw uint64_t values (.bin suffix)
+// COMPRESSED: 8-byte magic, number of values, LEB128 varints (.vz suffix);
+//             unreached vertices (LONG_MAX) are stored as 0, others as value + 1
+enum class ResultFormat { TEXT, BINARY, COMPRESSED };
+
+// Buffered writer for per-vertex results.
+// Values are formatted into per-thread buffers (on the shared ThreadPool) and flushed with large write() calls;
+// write_async copies the values and does all the work in a background thread,
+// so the caller can reuse its result array right away
+class ResultWriter {
+    ResultFormat format;
+    unsigned num_threads;
+    std::thread worker;
+    std::vector<uint64_t> pending;
+
+    void write_file(const std::string &filename, const uint64_t *values, uint64_t n);
+
+public:
+    // num_threads = number of formatting buffers (0: the size of the ThreadPool)
+    explicit ResultWriter(ResultFormat format = ResultFormat::TEXT, unsigned num_threads = 0);
+
+    ~ResultWriter() { wait(); }
+
+    ResultWriter(const ResultWriter &) = delete;
+    ResultWriter &operator=(const ResultWriter &) = delete;
+
+    // write values[0..n) to filename (plus the format suffix), blocking
+    void write(const std::string &filename, const uint64_t *values, uint64_t n);
+
+    // same as write, but returns immediately; waits for the previous write if any
+    void write_async(const std::string &filename, const uint64_t *values, uint64_t n);
+
+    // block until the background write (if any) is completed
+    void wait();
+
+    // write real-valued results (scores of bc, pagerank, ...) as "vertex value" text lines with
+    // 10 significant digits, whatever the format; blocking
+    void write_scores(const std::string &filename, const double *values, uint64_t n);
+
+    // file name actually written for a given base name
+    std::string path(const std::string &filename) const;
+
+    // read back a result file in any of the formats (detected by its header)
+    static std::vector<uint64_t> read(const std::string &filename);
+};
+
+#endif //ORACLE_CONTEST_RESULTWRITER_H
@@ -0,0 +1,118 @@
+#ifndef ORACLE_CONTEST_REVERSEINDEX_H
+#define ORACLE_CONTEST_REVERSEINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include "GraphBuilder.h"
+#include "NeighborSpan.h"
+
+// Transpose (CSC) of a graph: in-neighbors of vertex i, sorted by id, with the weight of each edge.
+// It is built with a parallel counting sort (see GraphBuilder.h) from the out-neighbors of any graph type,
+// the first time ensure() is called, and kept for the lifetime of the graph
+template<typename Id>
+class ReverseIndex {
+public:
+    class EdgeIter {
+    public:
+        class iterator {
+        public:
+            iterator(const Id *ptr, const float *w_ptr) : ptr(ptr), w_ptr(w_ptr) {}
+
+            iterator operator++() {
+                ++ptr;
+                ++w_ptr;
+                return *this;
+            }
+
+            bool operator!=(const iterator &other) { return ptr != other.ptr; }
+
+            const std::pair<uint64_t, double> &operator*() {
+                current.first = *ptr;
+                current.second = *w_ptr;
+                return current;
+            };
+
+        private:
+            const Id *ptr;
+            const float *w_ptr;
+            std::pair<uint64_t, double> current;
+        };
+
+    private:
+        const Id *begin_ptr, *end_ptr;
+        const float *begin_w_ptr;
+    public:
+        EdgeIter(const Id *begin_ptr, const Id *end_ptr, const float *begin_w_ptr) : begin_ptr(begin_ptr), end_ptr(end_ptr), begin_w_ptr(begin_w_ptr) {}
+
+        iterator begin() const { return iterator(begin_ptr, begin_w_ptr); }
+
+        iterator end() const { return iterator(end_ptr, begin_w_ptr); }
+    };
+
+private:
+    uint64_t n;         // number of vertex slots
+    uint64_t *offsets;  // in-neighbors of i are ids[offsets[i]..offsets[i+1])
+    Id *ids;
+    float *weights;
+    std::once_flag once;
+
+    // counting sort of the reversed out-edges: visiting the sources in order,
+    // in-neighbors come out sorted by id
+    template<typename G>
+    void build(G &graph, uint64_t num_vertices) {
+        n = num_vertices;
+        ReversedGraphEdges<G> reversed(graph, n);
+        offsets = new uint64_t[n + 1];
+        count_degrees(reversed, n, offsets);
+        ids = new Id[offsets[n]];
+        weights = new float[offsets[n]];
+        scatter_edges(reversed, n, offsets, [this](uint64_t p, uint64_t from, double weight) {
+            ids[p] = (Id)from;
+            weights[p] = (float)weight;
+        });
+    }
+
+public:
+    ReverseIndex() : n(0), offsets(nullptr), ids(nullptr), weights(nullptr) {}
+
+    ~ReverseIndex() {
+        delete[] offsets;
+        delete[] ids;
+        delete[] weights;
+    }
+
+    ReverseIndex(const ReverseIndex &) = delete;
+    ReverseIndex &operator=(const ReverseIndex &) = delete;
+
+    // build the index from graph (vertices 0..num_vertices-1) unless already built; thread-safe
+    template<typename G>
+    void ensure(G &graph, uint64_t num_vertices) {
+        std::call_once(once, [this, &graph, num_vertices]() { build(graph, num_vertices); });
+    }
+
+    bool built() const { return offsets != nullptr; }
+
+    EdgeIter get_neighbors(uint64_t idx) const {
+        return EdgeIter(ids + offsets[idx], ids + offsets[idx + 1], weights + offsets[idx]);
+    }
+
+    NeighborSpan<Id> neighbors(uint64_t idx) const {
+        return NeighborSpan<Id>(Span<Id>(ids + offsets[idx], ids + offsets[idx + 1]), Span<float>(weights + offsets[idx], weights + offsets[idx + 1]));
+    }
+
+    template<typename F>
+    inline void for_each_neighbor(uint64_t idx, F f) const {
+        for (uint64_t i = offsets[idx]; i < offsets[idx + 1]; i++)
+            f((uint64_t)ids[i], (double)weights[i]);
+    }
+
+    inline uint64_t degree(uint64_t idx) const { return offsets[idx + 1] - offsets[idx]; }
+
+    uint64_t size_in_bytes() const {
+        return built() ? (n + 1) * sizeof(uint64_t) + offsets[n] * (sizeof(Id) + sizeof(float)) : 0;
+    }
+};
+
+#endif //ORACLE_CONTEST_REVERSEINDEX_H
@@ -0,0 +1,196 @@
+#ifndef ORACLE_CONTEST_SCC_H
+#define ORACLE_CONTEST_SCC_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "ThreadPool.h"
+
+// Parallel strongly connected components (trimming, then Forward-Backward for the largest
+// component, then coloring for the rest, as in the Multistep algorithm).
+// Out-edges come from graph.for_each_neighbor, in-edges from graph.for_each_in_neighbor.
+
+// level-synchronous parallel search from frontier: neighbors(x, f) calls f(y) on the candidates
+// of x, and y joins the next level if claim(y) succeeds (at most once per vertex)
+template<typename Neighbors, typename Claim>
+void scc_reach(std::vector<uint64_t> frontier, Neighbors neighbors, Claim claim) {
+    ThreadPool &pool = ThreadPool::instance();
+    std::mutex mutex;
+    std::vector<uint64_t> next;
+    while (!frontier.empty()) {
+        next.clear();
+        pool.parallel_for_range(0, frontier.size(), [&](uint64_t lo, uint64_t hi) {
+            std::vector<uint64_t> local;
+            for (uint64_t i = lo; i < hi; i++)
+                neighbors(frontier[i], [&](uint64_t y) {
+                    if (claim(y))
+                        local.push_back(y);
+                });
+            std::lock_guard<std::mutex> lock(mutex);
+            next.insert(next.end(), local.begin(), local.end());
+        });
+        frontier.swap(next);
+    }
+}
+
+// labels[i] = smallest vertex id of the component of i, for i in [0, n); returns the number of components
+template<typename G>
+uint64_t strongly_connected_components(G &graph, uint64_t n, uint64_t *labels) {
+    ThreadPool &pool = ThreadPool::instance();
+    const uint64_t NONE = UINT64_MAX;
+    std::vector<uint8_t> active(n, 1);
+    std::vector<uint64_t> in_deg(n), out_deg(n);
+    uint64_t *rep = labels;     // a vertex of the component, replaced by the smallest one at the end
+
+    // build the transpose before going parallel
+    if (n > 0)
+        graph.in_degree(0);
+    pool.parallel_for(0, n, [&](uint64_t i) {
+        rep[i] = NONE;
+        in_deg[i] = graph.in_degree(i);
+        out_deg[i] = graph.degree(i);
+    });
+
+    // 1. trimming: vertices without in-edges or out-edges (among the remaining ones) are components by themselves
+    std::vector<uint64_t> trimmed;
+    for (uint64_t i = 0; i < n; i++)
+        if (in_deg[i] == 0 || out_deg[i] == 0) {
+            active[i] = 0;
+            trimmed.push_back(i);
+        }
+    auto trim = [&](uint64_t *deg, uint64_t y) {
+        return active[y] && __atomic_sub_fetch(&deg[y], 1, __ATOMIC_RELAXED) == 0 && __atomic_exchange_n(&active[y], 0, __ATOMIC_RELAXED);
+    };
+    std::vector<uint64_t> frontier = trimmed;
+    std::mutex mutex;
+    while (!frontier.empty()) {
+        std::vector<uint64_t> next;
+        pool.parallel_for_range(0, frontier.size(), [&](uint64_t lo, uint64_t hi) {
+            std::vector<uint64_t> local;
+            for (uint64_t i = lo; i < hi; i++) {
+                graph.for_each_neighbor(frontier[i], [&](uint64_t y, double) {
+                    if (trim(in_deg.data(), y))
+                        local.push_back(y);
+                });
+                graph.for_each_in_neighbor(frontier[i], [&](uint64_t y, double) {
+                    if (trim(out_deg.data(), y))
+                        local.push_back(y);
+                });
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            next.insert(next.end(), local.begin(), local.end());
+        });
+        trimmed.insert(trimmed.end(), next.begin(), next.end());
+        frontier.swap(next);
+    }
+    pool.parallel_for(0, trimmed.size(), [&](uint64_t i) { rep[trimmed[i]] = trimmed[i]; });
+
+    // 2. Forward-Backward from the vertex most likely in the largest component:
+    // its component is made of the vertices of its forward set that reach it backward
+    uint64_t pivot = NONE, best = 0;
+    for (uint64_t i = 0; i < n; i++)
+        if (active[i] && (pivot == NONE || in_deg[i] * out_deg[i] > best)) {
+            pivot = i;
+            best = in_deg[i] * out_deg[i];
+        }
+    if (pivot != NONE) {
+        std::vector<uint8_t> forward(n, 0);
+        forward[pivot] = 1;
+        scc_reach(std::vector<uint64_t>(1, pivot), [&](uint64_t x, const std::function<void(uint64_t)> &f) {
+            graph.for_each_neighbor(x, [&](uint64_t y, double) { if (active[y]) f(y); });
+        }, [&](uint64_t y) { return __atomic_exchange_n(&forward[y], 1, __ATOMIC_RELAXED) == 0; });
+        rep[pivot] = pivot;
+        scc_reach(std::vector<uint64_t>(1, pivot), [&](uint64_t x, const std::function<void(uint64_t)> &f) {
+            graph.for_each_in_neighbor(x, [&](uint64_t y, double) { if (forward[y]) f(y); });
+        }, [&](uint64_t y) {
+            uint64_t expected = NONE;
+            return __atomic_compare_exchange_n(&rep[y], &expected, pivot, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        });
+    }
+    pool.parallel_for(0, n, [&](uint64_t i) { active[i] = 0; });
+
+    // 3. coloring: propagate the largest id along out-edges; every vertex whose color is its own id
+    // (a root) gets the vertices of its color that reach it backward as its component
+    std::vector<uint64_t> remaining;
+    for (uint64_t i = 0; i < n; i++)
+        if (rep[i] == NONE)
+            remaining.push_back(i);
+    std::vector<uint64_t> color(n);
+    std::vector<uint8_t> queued(n, 0);
+    while (!remaining.empty()) {
+        for (uint64_t x : remaining) {
+            active[x] = 1;
+            color[x] = x;
+        }
+        frontier = remaining;
+        while (!frontier.empty()) {
+            std::vector<uint64_t> next;
+            pool.parallel_for_range(0, frontier.size(), [&](uint64_t lo, uint64_t hi) {
+                std::vector<uint64_t> local;
+                for (uint64_t i = lo; i < hi; i++) {
+                    uint64_t c = __atomic_load_n(&color[frontier[i]], __ATOMIC_RELAXED);
+                    graph.for_each_neighbor(frontier[i], [&](uint64_t y, double) {
+                        if (!active[y])
+                            return;
+                        uint64_t old = __atomic_load_n(&color[y], __ATOMIC_RELAXED);
+                        while (old < c && !__atomic_compare_exchange_n(&color[y], &old, c, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+                        if (old < c && __atomic_exchange_n(&queued[y], 1, __ATOMIC_RELAXED) == 0)
+                            local.push_back(y);
+                    });
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                next.insert(next.end(), local.begin(), local.end());
+            });
+            for (uint64_t y : next)
+                queued[y] = 0;
+            frontier.swap(next);
+        }
+
+        // colors are disjoint, so every root can search on its own
+        std::vector<uint64_t> roots;
+        for (uint64_t x : remaining)
+            if (color[x] == x)
+                roots.push_back(x);
+        pool.parallel_for(0, roots.size(), [&](uint64_t r) {
+            uint64_t root = roots[r];
+            std::vector<uint64_t> stack(1, root);
+            rep[root] = root;
+            while (!stack.empty()) {
+                uint64_t x = stack.back();
+                stack.pop_back();
+                graph.for_each_in_neighbor(x, [&](uint64_t y, double) {
+                    if (active[y] && color[y] == root && rep[y] == NONE) {
+                        rep[y] = root;
+                        stack.push_back(y);
+                    }
+                });
+            }
+        }, 1);
+
+        std::vector<uint64_t> left;
+        for (uint64_t x : remaining) {
+            active[x] = 0;
+            if (rep[x] == NONE)
+                left.push_back(x);
+        }
+        remaining.swap(left);
+    }
+
+    // label every component with its smallest vertex
+    std::vector<uint64_t> smallest(n, NONE);
+    pool.parallel_for(0, n, [&](uint64_t i) {
+        uint64_t old = __atomic_load_n(&smallest[rep[i]], __ATOMIC_RELAXED);
+        while (i < old && !__atomic_compare_exchange_n(&smallest[rep[i]], &old, i, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    });
+    pool.parallel_for(0, n, [&](uint64_t i) { labels[i] = smallest[rep[i]]; });
+    return pool.parallel_reduce(0, n, (uint64_t)0, [&](uint64_t lo, uint64_t hi) {
+        uint64_t count = 0;
+        for (uint64_t i = lo; i < hi; i++)
+            count += labels[i] == i;
+        return count;
+    }, [](uint64_t a, uint64_t b) { return a + b; });
+}
+
+#endif //ORACLE_CONTEST_SCC_H
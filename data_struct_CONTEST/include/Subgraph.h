@@ -0,0 +1,110 @@
+#ifndef ORACLE_CONTEST_SUBGRAPH_H
+#define ORACLE_CONTEST_SUBGRAPH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "EdgeList.h"
+#include "ThreadPool.h"
+
+// Induced subgraph of a graph on a set of vertices, relabeled with dense ids: vertex i of the
+// subgraph is original[i] in the parent graph, and original is sorted, so ids keep their
+// relative order. The edges between the vertices of the set are held as a directed EdgeList,
+// ready to populate any graph type (GraphAlgorithm<T> sub(size(), edges.size()); sub.populate(edges))
+// without parsing the parent graph again. Works on any graph type with for_each_neighbor.
+class Subgraph {
+public:
+    EdgeList edges;
+    std::vector<uint64_t> original;
+
+    uint64_t size() const { return original.size(); }
+
+    // new id of a vertex of the parent graph, UINT64_MAX if not in the subgraph
+    uint64_t relabel(uint64_t id) const {
+        auto it = std::lower_bound(original.begin(), original.end(), id);
+        return it != original.end() && *it == id ? it - original.begin() : UINT64_MAX;
+    }
+
+    // write graphName.v and graphName.e (new ids, weights if any), and graphName.map
+    // ("new original" lines); false on errors
+    bool write(const std::string &graphName) const;
+};
+
+// the subgraph induced by vertices (in any order, duplicates and ids >= n are dropped), in time
+// proportional to the out-edges of the vertices: each one keeps the neighbors found (by binary
+// search) in the sorted set, in the order of its edges. Ranges of vertices are extracted in
+// parallel, each into its own chunk of edges
+template<typename G>
+Subgraph induced_subgraph(G &graph, uint64_t n, std::vector<uint64_t> vertices) {
+    ThreadPool &pool = ThreadPool::instance();
+    Subgraph sub;
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+    vertices.erase(std::lower_bound(vertices.begin(), vertices.end(), n), vertices.end());
+    sub.original = std::move(vertices);
+    const std::vector<uint64_t> &original = sub.original;
+    const uint64_t k = original.size();
+
+    const uint64_t num_chunks = std::max<uint64_t>(1, std::min<uint64_t>(k, 8 * pool.size()));
+    std::vector<EdgeChunk> chunks(num_chunks);
+    std::vector<uint8_t> weighted(num_chunks, 0);
+    pool.parallel_for(0, num_chunks, [&](uint64_t c) {
+        EdgeChunk &chunk = chunks[c];
+        for (uint64_t i = c * k / num_chunks; i < (c + 1) * k / num_chunks; i++)
+            graph.for_each_neighbor(original[i], [&](uint64_t to, double weight) {
+                auto it = std::lower_bound(original.begin(), original.end(), to);
+                if (it != original.end() && *it == to) {
+                    chunk.src.push_back((uint32_t)i);
+                    chunk.dst.push_back((uint32_t)(it - original.begin()));
+                    chunk.weight.push_back((float)weight);
+                    weighted[c] |= weight != 1.0;
+                }
+            });
+    }, 1);
+    sub.edges.assign(std::move(chunks), std::find(weighted.begin(), weighted.end(), 1) != weighted.end());
+    return sub;
+}
+
+// the vertices within k hops (along out-edges) of the seeds, seeds included, in time proportional
+// to the out-edges of the vertices found: every level expands the frontier in parallel, then the
+// new vertices are picked serially in a hash set
+template<typename G>
+std::vector<uint64_t> khop_neighborhood(G &graph, uint64_t n, const std::vector<uint64_t> &seeds, uint64_t k) {
+    ThreadPool &pool = ThreadPool::instance();
+    std::unordered_set<uint64_t> found;
+    std::vector<uint64_t> result, frontier;
+    for (uint64_t s : seeds)
+        if (s < n && found.insert(s).second)
+            frontier.push_back(s);
+    result = frontier;
+    std::mutex mutex;
+    for (uint64_t level = 0; level < k && !frontier.empty(); level++) {
+        std::vector<uint64_t> reached;
+        pool.parallel_for_range(0, frontier.size(), [&](uint64_t lo, uint64_t hi) {
+            std::vector<uint64_t> local;
+            for (uint64_t i = lo; i < hi; i++)
+                graph.for_each_neighbor(frontier[i], [&](uint64_t to, double) {
+                    if (!found.count(to))
+                        local.push_back(to);
+                });
+            std::lock_guard<std::mutex> lock(mutex);
+            reached.insert(reached.end(), local.begin(), local.end());
+        });
+        frontier.clear();
+        for (uint64_t x : reached)
+            if (found.insert(x).second)
+                frontier.push_back(x);
+        result.insert(result.end(), frontier.begin(), frontier.end());
+    }
+    return result;
+}
+
+// count distinct vertices drawn uniformly from [0, n) (all of them if count >= n), with Floyd's
+// algorithm: time and memory proportional to count
+std::vector<uint64_t> random_vertices(uint64_t n, uint64_t count, uint64_t seed);
+
+#endif //ORACLE_CONTEST_SUBGRAPH_H
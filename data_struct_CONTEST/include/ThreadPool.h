@@ -0,0 +1,139 @@
+#ifndef ORACLE_CONTEST_THREADPOOL_H
+#define ORACLE_CONTEST_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tasks spawned in a group can be waited for together
+struct TaskGroup {
+    std::atomic<uint64_t> pending;
+
+    TaskGroup() : pending(0) {}
+};
+
+// Work-stealing thread pool shared by graph builders and kernels.
+// Every worker owns a deque: it pushes and pops tasks at the back, while idle workers
+// steal from the front of the others. Threads outside the pool (e.g. main) share deque 0,
+// and help running tasks while they wait for a group, so parallel calls can be nested
+class ThreadPool {
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    unsigned num_threads;
+    std::vector<std::unique_ptr<Worker> > workers;
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> queued;
+    std::atomic<bool> stop;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+
+    static std::unique_ptr<ThreadPool> global;
+
+    void worker_loop(unsigned id, bool pin);
+    bool find_task(std::function<void()> &task);
+
+    // run f on [lo, hi), splitting off the upper half as a stealable task
+    // only while the local deque is empty (lazy binary splitting): when other
+    // workers are busy, no task is created and the range is consumed grain by grain
+    template<typename F>
+    void run_range(TaskGroup &group, uint64_t lo, uint64_t hi, const F &f, uint64_t grain) {
+        while (hi - lo > grain) {
+            if (local_tasks() > 0) {
+                f(lo, lo + grain);
+                lo += grain;
+                continue;
+            }
+            uint64_t mid = lo + (hi - lo) / 2;
+            spawn(group, [this, &group, mid, hi, &f, grain]() { run_range(group, mid, hi, f, grain); });
+            hi = mid;
+        }
+        f(lo, hi);
+    }
+
+    uint64_t local_tasks();
+
+public:
+    // num_threads = 0 means one thread per hardware thread;
+    // if pin, worker i is bound to CPU i (modulo the available CPUs)
+    explicit ThreadPool(unsigned num_threads = 0, bool pin = false);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // the pool shared by the whole program
+    static ThreadPool &instance();
+
+    // replace the shared pool; call it before any parallel work starts
+    static void configure(unsigned num_threads, bool pin);
+
+    unsigned size() const { return num_threads; }
+
+    // index in [0, size()) of the worker running the caller; 0 for all the threads outside the pool,
+    // so per-worker state is only safe in parallel calls made by a single outside thread
+    unsigned current_worker() const;
+
+    // queue task in group
+    void spawn(TaskGroup &group, std::function<void()> task);
+
+    // run queued tasks until all the tasks of group are completed
+    void wait(TaskGroup &group);
+
+    // f(lo, hi) on subranges of [lo, hi); grain is the minimum subrange size (0: automatic)
+    template<typename F>
+    void parallel_for_range(uint64_t lo, uint64_t hi, F f, uint64_t grain = 0) {
+        if (hi <= lo)
+            return;
+        if (grain == 0)
+            grain = std::max<uint64_t>(1, (hi - lo) / (64 * num_threads));
+        if (num_threads == 1 || hi - lo <= grain) {
+            f(lo, hi);
+            return;
+        }
+        TaskGroup group;
+        run_range(group, lo, hi, f, grain);
+        wait(group);
+    }
+
+    // f(i) for every i in [lo, hi)
+    template<typename F>
+    void parallel_for(uint64_t lo, uint64_t hi, F f, uint64_t grain = 0) {
+        parallel_for_range(lo, hi, [&f](uint64_t a, uint64_t b) {
+            for (uint64_t i = a; i < b; i++)
+                f(i);
+        }, grain);
+    }
+
+    // reduce(map(a, b), ...) over fixed blocks of [lo, hi): blocks are combined in order,
+    // so the result does not depend on scheduling (for a given pool size)
+    template<typename T, typename M, typename R>
+    T parallel_reduce(uint64_t lo, uint64_t hi, T identity, M map, R reduce, uint64_t grain = 1024) {
+        if (hi <= lo)
+            return identity;
+        uint64_t num_blocks = std::max<uint64_t>(1, std::min<uint64_t>((hi - lo) / grain, 8 * num_threads));
+        uint64_t block = (hi - lo + num_blocks - 1) / num_blocks;
+        std::vector<T> partial(num_blocks, identity);
+        parallel_for(0, num_blocks, [&](uint64_t b) {
+            uint64_t a = lo + b * block;
+            if (a < hi)
+                partial[b] = map(a, std::min(hi, a + block));
+        }, 1);
+        T result = identity;
+        for (uint64_t b = 0; b < num_blocks; b++)
+            result = reduce(result, partial[b]);
+        return result;
+    }
+};
+
+#endif //ORACLE_CONTEST_THREADPOOL_H
@@ -0,0 +1,101 @@
+#ifndef ORACLE_CONTEST_TRAVERSALSTATE_H
+#define ORACLE_CONTEST_TRAVERSALSTATE_H
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Hot-path counters of the last traversal, updated through the TRAVERSAL_COUNT* macros below, which
+// compile to nothing unless TRAVERSAL_COUNTERS is defined (make counters)
+struct TraversalCounters {
+    uint64_t edges;         // edges scanned
+    uint64_t vertices;      // vertices visited (expanded)
+    uint64_t redundant;     // edges scanned to vertices already visited
+    std::vector<uint64_t> frontier;     // vertices reached at every BFS level
+
+    TraversalCounters() : edges(0), vertices(0), redundant(0) {}
+
+    void reset() {
+        edges = vertices = redundant = 0;
+        frontier.clear();
+    }
+
+    inline void level(uint64_t l, uint64_t count) {
+        if (frontier.size() <= l)
+            frontier.resize(l + 1, 0);
+        frontier[l] += count;
+    }
+};
+
+#ifdef TRAVERSAL_COUNTERS
+#define TRAVERSAL_COUNT_RESET(s) (s).counters.reset()
+#define TRAVERSAL_COUNT(s, counter, n) ((s).counters.counter += (n))
+#define TRAVERSAL_COUNT_ATOMIC(s, counter, n) __atomic_fetch_add(&(s).counters.counter, (n), __ATOMIC_RELAXED)
+#define TRAVERSAL_COUNT_LEVEL(s, l, n) (s).counters.level(l, n)
+#else
+#define TRAVERSAL_COUNT_RESET(s) do {} while (0)
+#define TRAVERSAL_COUNT(s, counter, n) do {} while (0)
+#define TRAVERSAL_COUNT_ATOMIC(s, counter, n) do {} while (0)
+#define TRAVERSAL_COUNT_LEVEL(s, l, n) do {} while (0)
+#endif
+
+// Per-traversal state of BFS/DFS over a graph with n vertex slots.
+// Kept apart from the graph, so that several traversals can run concurrently on the same graph.
+// Full traversals (bfs, dfs) initialize the arrays on their own; sparse traversals (khop, distance)
+// record the vertices they touch instead, and reset() clears just those before the next one
+struct TraversalState {
+    uint64_t n;
+    uint64_t *dist;     // result of the last traversal (LONG_MAX if unreached)
+    bool *used;
+    uint64_t *visited;  // bitmap version of used, for graphs with bitmap adjacency
+    uint64_t *rdist;    // distance to the target of a bidirectional search (see reverse_dist)
+    uint64_t last;      // last DFS visiting order assigned
+    std::vector<uint64_t> touched;  // entries set by the last sparse traversal
+    bool dirty;         // set by full traversals: the next reset() clears everything
+    TraversalCounters counters;     // in the counters build only
+
+    explicit TraversalState(uint64_t n) : n(n), rdist(nullptr), last(0), dirty(true) {
+        dist = new uint64_t[n];
+        used = new bool[n];
+        visited = nullptr;
+    }
+
+    ~TraversalState() {
+        delete[] dist;
+        delete[] used;
+        delete[] visited;
+        delete[] rdist;
+    }
+
+    // dist (and rdist) back to LONG_MAX everywhere, in time proportional to the entries touched
+    // since the last reset, unless a full traversal ran in between
+    void reset() {
+        if (dirty) {
+            for (uint64_t i = 0; i < n; i++)
+                dist[i] = LONG_MAX;
+            dirty = false;
+        } else {
+            for (uint64_t i : touched)
+                dist[i] = LONG_MAX;
+        }
+        if (rdist)
+            for (uint64_t i : touched)
+                rdist[i] = LONG_MAX;
+        touched.clear();
+    }
+
+    uint64_t *reverse_dist() {
+        if (!rdist) {
+            rdist = new uint64_t[n];
+            for (uint64_t i = 0; i < n; i++)
+                rdist[i] = LONG_MAX;
+        }
+        return rdist;
+    }
+
+    TraversalState(const TraversalState &) = delete;
+    TraversalState &operator=(const TraversalState &) = delete;
+};
+
+#endif //ORACLE_CONTEST_TRAVERSALSTATE_H
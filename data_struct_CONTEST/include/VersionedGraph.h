@@ -0,0 +1,236 @@
+#ifndef ORACLE_CONTEST_VERSIONEDGRAPH_H
+#define ORACLE_CONTEST_VERSIONEDGRAPH_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "CSRGraph.h"
+#include "EdgeList.h"
+#include "ReverseIndex.h"
+
+// Epoch-based reclamation: readers announce the epoch they entered in one of SLOTS slots for as
+// long as they may hold pointers to shared objects; objects unlinked by a writer are retired
+// with the epoch of their unlinking (which advances the epoch), and reclaimed once no reader
+// entered at or before that epoch is still inside. Readers are expected to stay inside for a
+// short while (enter spins while all the slots are taken)
+class EpochManager {
+public:
+    static const unsigned SLOTS = 64;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> epoch;    // 0: free
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    std::atomic<uint64_t> epoch;
+    Slot slots[SLOTS];
+    std::mutex mutex;
+    // epoch of retirement, and the function freeing the object (false if it is still referenced)
+    std::vector<std::pair<uint64_t, std::function<bool()> > > retired;
+
+public:
+    EpochManager();
+
+    // enter the current epoch; returns the slot to leave
+    unsigned enter();
+
+    void leave(unsigned slot);
+
+    // retire an object just unlinked: reclaim is called (until it returns true) once no reader can reach it
+    void retire(std::function<bool()> reclaim);
+
+    // reclaim what can be reclaimed; returns the number of objects still retired
+    uint64_t collect();
+};
+
+// Adjacency of BLOCK consecutive vertices: the neighbors of the i-th one are
+// ids[offsets[i]..offsets[i+1]), with weights. Immutable once published
+struct AdjacencyBlock {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> ids;
+    std::vector<float> weights;
+
+    uint64_t size_in_bytes() const {
+        return sizeof(AdjacencyBlock) + offsets.size() * sizeof(uint32_t) + ids.size() * (sizeof(uint32_t) + sizeof(float));
+    }
+};
+
+// A version of the graph: the out- and in-adjacency blocks, shared with the other versions
+// except for the blocks changed in between, and the number of snapshots reading it
+struct GraphVersion {
+    uint64_t number;
+    uint64_t edges;
+    std::vector<std::shared_ptr<const AdjacencyBlock> > out, in;
+    mutable std::atomic<uint64_t> readers;
+
+    GraphVersion() : number(0), edges(0), readers(0) {}
+};
+
+// Versioned implementation of Graph with snapshot isolation, for reading while edges are added.
+// The adjacency (out-edges, and in-edges sorted by id as in ReverseIndex) is split in blocks of
+// BLOCK vertices; apply() adds a batch of edges copying only the blocks it changes into a new
+// version, which is then published atomically. A single writer at a time publishes versions
+// (writers are serialized); readers never lock:
+// - snapshot() pins the current version (reference counted), within an epoch of the EpochManager
+//   only for the time of reading the current version and taking the reference;
+// - a SnapshotScope makes the reads of the graph on its thread (for_each_neighbor, degree, ...)
+//   go to the version of its snapshot, so that a traversal sees a consistent graph;
+// - reads outside a SnapshotScope go to the current version, and must not overlap with apply().
+// Replaced versions are retired to the EpochManager and freed, with the blocks only they
+// reference, once no reader can reach them and no snapshot holds them.
+// Snapshots must be released before the graph. The vertex slots are fixed at construction
+class VersionedGraph {
+public:
+    static const uint64_t BLOCK = 64;
+    typedef ReverseIndex<uint32_t>::EdgeIter EdgeIter;
+
+    // a pinned version; movable, released on destruction
+    class Snapshot {
+        friend class VersionedGraph;
+        VersionedGraph *graph;
+        const GraphVersion *version;
+
+        Snapshot(VersionedGraph *graph, const GraphVersion *version) : graph(graph), version(version) {}
+
+    public:
+        Snapshot(Snapshot &&other) : graph(other.graph), version(other.version) { other.version = nullptr; }
+
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+
+        ~Snapshot() {
+            if (version)
+                graph->release(version);
+        }
+
+        uint64_t number() const { return version->number; }
+
+        uint64_t edges() const { return version->edges; }
+    };
+
+    // reads of the graph of snapshot on this thread go to its version, for the lifetime of the
+    // scope; does nothing if snapshot is nullptr
+    class SnapshotScope {
+        const VersionedGraph *previous_graph;
+        const GraphVersion *previous_version;
+
+    public:
+        explicit SnapshotScope(const Snapshot *snapshot) : previous_graph(pinned.graph), previous_version(pinned.version) {
+            if (snapshot) {
+                pinned.graph = snapshot->graph;
+                pinned.version = snapshot->version;
+            }
+        }
+
+        ~SnapshotScope() {
+            pinned.graph = previous_graph;
+            pinned.version = previous_version;
+        }
+    };
+
+private:
+    struct Pinned {
+        const VersionedGraph *graph;
+        const GraphVersion *version;
+    };
+
+    // version of the SnapshotScope of this thread
+    static thread_local Pinned pinned;
+
+    uint64_t v, e;
+    std::atomic<const GraphVersion *> current;
+    EpochManager epochs;
+    std::mutex writer;
+
+    inline const GraphVersion &version() const {
+        return pinned.graph == this ? *pinned.version : *current.load(std::memory_order_acquire);
+    }
+
+    void build(CSRGraph &csr);
+
+    void release(const GraphVersion *version);
+
+public:
+    VersionedGraph(uint64_t v, uint64_t e) : v(v), e(e), current(nullptr) {}
+
+    ~VersionedGraph();
+
+    // pin the current version
+    Snapshot snapshot();
+
+    // add a batch of edges (from, to, weight), publishing a new version: out-edges are appended to
+    // the neighbors of from in batch order, in-edges are inserted in id order. The number of the
+    // new version and its (directed) edges are stored in number and edges, if given. Returns false
+    // (printing an error, nothing applied) if a vertex is out of range
+    bool apply(const std::vector<std::tuple<uint64_t, uint64_t, double> > &batch, uint64_t *number = nullptr, uint64_t *edges = nullptr);
+
+    // number of the current version (0: as populated), and versions retired but not freed yet
+    uint64_t version_number() const { return current.load()->number; }
+
+    uint64_t retired_versions() { return epochs.collect(); }
+
+    EdgeIter get_neighbors(uint64_t idx) {
+        const AdjacencyBlock &b = *version().out[idx / BLOCK];
+        const uint64_t i = idx % BLOCK;
+        return EdgeIter(b.ids.data() + b.offsets[i], b.ids.data() + b.offsets[i + 1], b.weights.data() + b.offsets[i]);
+    }
+
+    template<typename F>
+    inline void for_each_neighbor(uint64_t idx, F f) const {
+        const AdjacencyBlock &b = *version().out[idx / BLOCK];
+        const uint64_t i = idx % BLOCK;
+        for (uint32_t k = b.offsets[i]; k < b.offsets[i + 1]; k++)
+            f((uint64_t)b.ids[k], (double)b.weights[k]);
+    }
+
+    inline uint64_t degree(uint64_t idx) const {
+        const AdjacencyBlock &b = *version().out[idx / BLOCK];
+        return b.offsets[idx % BLOCK + 1] - b.offsets[idx % BLOCK];
+    }
+
+    // in-neighbors of idx, sorted by id (kept in every version, no transpose to build)
+    EdgeIter get_in_neighbors(uint64_t idx) {
+        const AdjacencyBlock &b = *version().in[idx / BLOCK];
+        const uint64_t i = idx % BLOCK;
+        return EdgeIter(b.ids.data() + b.offsets[i], b.ids.data() + b.offsets[i + 1], b.weights.data() + b.offsets[i]);
+    }
+
+    template<typename F>
+    inline void for_each_in_neighbor(uint64_t idx, F f) const {
+        const AdjacencyBlock &b = *version().in[idx / BLOCK];
+        const uint64_t i = idx % BLOCK;
+        for (uint32_t k = b.offsets[i]; k < b.offsets[i + 1]; k++)
+            f((uint64_t)b.ids[k], (double)b.weights[k]);
+    }
+
+    inline uint64_t in_degree(uint64_t idx) const {
+        const AdjacencyBlock &b = *version().in[idx / BLOCK];
+        return b.offsets[idx % BLOCK + 1] - b.offsets[idx % BLOCK];
+    }
+
+    // memory used by the version read (retired versions not counted)
+    uint64_t size_in_bytes() const;
+
+    uint64_t reverse_index_size_in_bytes() const;
+
+    void add_edge(uint64_t from, uint64_t to, double weight = 1) {
+        apply(std::vector<std::tuple<uint64_t, uint64_t, double> >(1, std::make_tuple(from, to, weight)));
+    }
+
+    void add_edges(uint64_t from, std::vector<uint64_t> &to, std::vector<double> &weights);
+
+    void finished();
+
+    void populate(std::tuple<uint64_t, uint64_t, double>* e_list);
+
+    // build the graph straight from the staged edges (both directions of undirected edges)
+    void populate(const EdgeList &edges);
+};
+
+#endif //ORACLE_CONTEST_VERSIONEDGRAPH_H
@@ -0,0 +1,174 @@
+#!/bin/bash
+
+# Regression suite: runs bin/exe on a catalog of graphs and checks
+# - that it exits cleanly (with the default stack size: the catalog has a deep graph for DFS);
+# - .bfs/.dfs outputs and BFS/DFS sums against golden files;
+# - populate/BFS/DFS times and memory usage against a recorded baseline.
+#
+# USAGE: bash regression.sh [-r] [-g] [-t tolerance_pct] [-i iterations] [-a "extra bin/exe args"]
+#   -r  record the timing baseline (run it on the reference version first)
+#   -g  record the golden files (only when an output change is intended, then commit them)
+#   -t  max slowdown / memory increase w.r.t. the baseline, in % (default: 20)
+#   -i  iterations per graph (default: 5)
+#   -a  extra arguments passed to bin/exe (e.g. the graph layout to test)
+#
+# Golden files are versioned in regression/golden (gzipped): the catalog graphs are bundled or
+# generated with fixed seeds (with the glibc rand()), so the outputs do not depend on the machine;
+# a checksum of each input graph is stored with them. The timing baseline,
+# regression/baseline.csv, is not versioned: timings only compare runs on the same machine, so
+# record it locally before changing the code. Without a baseline (or a baseline entry for a
+# graph) only the outputs are checked.
+# Times are the fastest of the iterations, memory the median. Timings below SLACK_MS ms
+# (default: 2) and memory below SLACK_MB MB (default: 1) are considered noise. A graph whose
+# timings are out of tolerance is run once more and checked on the fastest of all runs.
+
+RECORD=0
+RECORD_GOLDEN=0
+TOLERANCE=20
+ITERATIONS=5
+EXE_ARGS=""
+SLACK_MS=${SLACK_MS:-2}
+SLACK_MB=${SLACK_MB:-1}
+while getopts "rgt:i:a:" opt; do
+    case $opt in
+        r) RECORD=1 ;;
+        g) RECORD_GOLDEN=1 ;;
+        t) TOLERANCE=$OPTARG ;;
+        i) ITERATIONS=$OPTARG ;;
+        a) EXE_ARGS=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+
+GOLDEN_DIR=regression/golden
+BASELINE=regression/baseline.csv
+
+# Graph catalog: name, path, source vertex, flags
+CATALOG=(
+    "example_directed data/example_directed 2"
+    "example_undirected data/example_undirected 2 -U"
+    "example_gaps data/example_gaps 1"
+    "PL2000_D0.5_S42 data/PL2000_D0.5_S42 0"
+    "PL2000_D0.5_S42_U data/PL2000_D0.5_S42_U 0 -U"
+    "PL100000_D0.005_S7 data/PL100000_D0.005_S7 0"
+    "PL1000000_D0.0008_S3 data/PL1000000_D0.0008_S3 1"
+)
+
+# Build the code and generate the power-law graphs (if missing)
+make > /dev/null || exit 1
+(cd graph_generator && make > /dev/null) || exit 1
+[ -f data/PL2000_D0.5_S42.e ] || (cd graph_generator && ./graphgen 2000 0.5 42 -P > /dev/null)
+[ -f data/PL2000_D0.5_S42_U.e ] || (cd graph_generator && ./graphgen 2000 0.5 42 -P -U > /dev/null)
+[ -f data/PL100000_D0.005_S7.e ] || (cd graph_generator && ./graphgen 100000 0.005 7 -P > /dev/null)
+[ -f data/PL1000000_D0.0008_S3.e ] || (cd graph_generator && ./graphgen 1000000 0.0008 3 -P > /dev/null)
+
+mkdir -p $GOLDEN_DIR
+if [ $RECORD -eq 1 ]; then
+    echo "graph,populate_ms,mem_mb,bfs_ms,dfs_ms" > $BASELINE
+fi
+
+# smallest value of a column of a CSV file
+minimum() {
+    cut -d, -f$2 $1 | sort -g | head -n 1
+}
+
+# median of a column of a CSV file
+median() {
+    cut -d, -f$2 $1 | sort -g | awk '{ v[NR] = $1 } END { print (NR % 2) ? v[(NR + 1) / 2] : (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+# check that $3 (current) is at most $2 (baseline) + tolerance, printing a failure for $1 otherwise
+within_tolerance() {
+    awk -v name="$1" -v base="$2" -v cur="$3" -v tol="$TOLERANCE" -v slack="$4" 'BEGIN {
+        limit = base * (1 + tol / 100) + slack
+        if (cur > limit) { printf "  FAIL %s: %s vs baseline %s (limit %.3f)\n", name, cur, base, limit; exit 1 }
+    }'
+}
+
+# check the times and memory in $2 against the baseline of graph $1
+check_timing() {
+    local ok=0
+    IFS=, read -r _ base_pop base_mem base_bfs base_dfs <<< "$(grep "^$1," $BASELINE)"
+    within_tolerance "populate time (ms)" $base_pop $(minimum $2 2) $SLACK_MS || ok=1
+    within_tolerance "memory (MB)" $base_mem $(median $2 3) $SLACK_MB || ok=1
+    within_tolerance "BFS time (ms)" $base_bfs $(minimum $2 4) $SLACK_MS || ok=1
+    within_tolerance "DFS time (ms)" $base_dfs $(minimum $2 6) $SLACK_MS || ok=1
+    return $ok
+}
+
+FAILURES=0
+for entry in "${CATALOG[@]}"; do
+    read -r name path src flags <<< "$entry"
+    echo "Checking $name"
+    OUT=$(mktemp)
+    rm -f $path.bfs $path.dfs
+    bin/exe $path $src $ITERATIONS $flags $EXE_ARGS > $OUT
+    status=$?
+    if [ $status -ne 0 ]; then
+        echo "  FAIL bin/exe exited with status $status"
+        FAILURES=$((FAILURES + 1))
+        rm $OUT
+        continue
+    fi
+    sums=$(head -n 1 $OUT | cut -d, -f5,7)
+
+    if [ $RECORD_GOLDEN -eq 1 ]; then
+        gzip -9 -n -c $path.bfs > $GOLDEN_DIR/$name.bfs.gz
+        gzip -9 -n -c $path.dfs > $GOLDEN_DIR/$name.dfs.gz
+        echo $sums > $GOLDEN_DIR/$name.sums
+        cksum < $path.e > $GOLDEN_DIR/$name.input
+    fi
+    if [ $RECORD -eq 1 ]; then
+        echo "$name,$(minimum $OUT 2),$(median $OUT 3),$(minimum $OUT 4),$(minimum $OUT 6)" >> $BASELINE
+    fi
+    if [ $RECORD -eq 1 ] || [ $RECORD_GOLDEN -eq 1 ]; then
+        rm $OUT
+        continue
+    fi
+
+    if [ ! -f $GOLDEN_DIR/$name.sums ]; then
+        echo "  FAIL no golden files for $name (record them with -g)"
+        FAILURES=$((FAILURES + 1))
+        rm $OUT
+        continue
+    fi
+
+    if [ "$(cksum < $path.e)" != "$(cat $GOLDEN_DIR/$name.input)" ]; then
+        echo "  FAIL $path.e is not the graph of the golden files (delete it to generate it again)"
+        FAILURES=$((FAILURES + 1))
+        rm $OUT
+        continue
+    fi
+
+    failed=0
+    for ext in bfs dfs; do
+        if ! gzip -dc $GOLDEN_DIR/$name.$ext.gz | cmp -s $path.$ext -; then
+            echo "  FAIL $ext output differs from $GOLDEN_DIR/$name.$ext.gz"
+            failed=1
+        fi
+    done
+    if [ "$sums" != "$(cat $GOLDEN_DIR/$name.sums)" ]; then
+        echo "  FAIL sums (BFS,DFS) are $sums, expected $(cat $GOLDEN_DIR/$name.sums)"
+        failed=1
+    fi
+    if [ -f $BASELINE ] && grep -q "^$name," $BASELINE; then
+        if ! check_timing $name $OUT > /dev/null; then
+            echo "  timings out of tolerance, running $name again"
+            bin/exe $path $src $ITERATIONS $flags $EXE_ARGS >> $OUT
+            check_timing $name $OUT || failed=1
+        fi
+    else
+        echo "  no timing baseline for $name (record one on this machine with -r): outputs only"
+    fi
+    [ $failed -eq 0 ] && echo "  OK"
+    FAILURES=$((FAILURES + failed))
+    rm $OUT
+done
+
+if [ $RECORD -eq 1 ] || [ $RECORD_GOLDEN -eq 1 ]; then
+    [ $RECORD_GOLDEN -eq 1 ] && echo "Golden files recorded in $GOLDEN_DIR"
+    [ $RECORD -eq 1 ] && echo "Baseline recorded in $BASELINE"
+    exit 0
+fi
+echo "$FAILURES graph(s) failed"
+[ $FAILURES -eq 0 ]
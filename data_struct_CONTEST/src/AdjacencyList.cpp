@@ -18,6 +18,11 @@ void AdjacencyList::populate(std::tuple<uint64_t, uint64_t, double>* e_list){
     finished();
 }
 
+void AdjacencyList::populate(const EdgeList &edges){
+    edges.for_each_edge([this](uint64_t from, uint64_t to, double weight) { add_edge(from, to, weight); });
+    finished();
+}
+
 void AdjacencyList::sortEdgesByNodeId() {
     for(uint64_t i = 0; i <= v; ++i)
         edges[i].sort();
@@ -0,0 +1,49 @@
+#include "../include/CSRGraph.h"
+#include "../include/GraphBuilder.h"
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <vector>
+
+// counting sort of the edges by source vertex, keeping their order
+template<typename Edges>
+void CSRGraph::build(const Edges &edges, bool weighted){
+    offsets = new uint64_t[v + 3];
+    count_degrees(edges, v + 2, offsets);
+    ids = new uint32_t[offsets[v + 2]];
+    weights = weighted ? new float[offsets[v + 2]] : nullptr;
+    scatter_edges(edges, v + 2, offsets, [this](uint64_t p, uint64_t to, double weight) {
+        ids[p] = (uint32_t)to;
+        if (weights)
+            weights[p] = (float)weight;
+    });
+    finished();
+}
+
+void CSRGraph::populate(std::tuple<uint64_t, uint64_t, double>* e_list){
+    build(TupleEdgeList(e_list, e), true);
+}
+
+void CSRGraph::populate(const EdgeList &edges){
+    build(edges, edges.is_weighted());
+}
+
+void CSRGraph::sortEdgesByNodeId() {
+    ThreadPool::instance().parallel_for_range(0, v + 2, [this](uint64_t lo, uint64_t hi) {
+        std::vector<std::pair<uint32_t, float> > tmp;
+        for(uint64_t i = lo; i < hi; ++i){
+            tmp.clear();
+            for(uint64_t j = offsets[i]; j < offsets[i + 1]; j++)
+                tmp.push_back(std::make_pair(ids[j], weights ? weights[j] : 1.0f));
+            std::stable_sort(tmp.begin(), tmp.end(),
+                [](const std::pair<uint32_t, float> &a, const std::pair<uint32_t, float> &b) { return a.first < b.first; });
+            for(uint64_t j = offsets[i]; j < offsets[i + 1]; j++){
+                ids[j] = tmp[j - offsets[i]].first;
+                if (weights)
+                    weights[j] = tmp[j - offsets[i]].second;
+            }
+        }
+    });
+}
+
+void CSRGraph::finished() {}
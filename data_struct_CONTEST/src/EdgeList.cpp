@@ -0,0 +1,188 @@
+#include "../include/EdgeList.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const uint64_t READ_BLOCK_SIZE = 1 << 24;
+
+static inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// parse an unsigned integer from [p, end), advancing p; returns false if there is no number
+static inline bool parse_u64(const char *&p, const char *end, uint64_t &x) {
+    while (p < end && is_blank(*p))
+        p++;
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+    x = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        x = x * 10 + (*p++ - '0');
+    return true;
+}
+
+// parse a float from [p, end) with the same rounding of std::stof
+static inline bool parse_float(const char *&p, const char *end, float &x) {
+    while (p < end && is_blank(*p))
+        p++;
+    char token[64];
+    uint64_t len = 0;
+    while (p < end && !is_blank(*p) && len < sizeof(token) - 1)
+        token[len++] = *p++;
+    token[len] = '\0';
+    char *token_end;
+    x = strtof(token, &token_end);
+    return len > 0 && token_end != token;
+}
+
+// count the fields of the first non-empty line of a block
+static int count_fields(const char *p, const char *end) {
+    while (p < end && (is_blank(*p) || *p == '\n'))
+        p++;
+    int fields = 0;
+    while (p < end && *p != '\n') {
+        fields++;
+        while (p < end && !is_blank(*p) && *p != '\n')
+            p++;
+        while (p < end && is_blank(*p))
+            p++;
+    }
+    return fields;
+}
+
+bool parse_edge_file(const std::string &filename, const std::function<void(EdgeChunk &)> &on_chunk, bool &weighted, uint64_t chunk_size) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "ERROR: cannot open " << filename << std::endl;
+        return false;
+    }
+    std::vector<char> buffer(READ_BLOCK_SIZE);
+    uint64_t filled = 0;
+    bool first_block = true;
+    bool eof = false;
+    EdgeChunk chunk;
+    chunk.src.reserve(chunk_size);
+    chunk.dst.reserve(chunk_size);
+    chunk.weight.reserve(chunk_size);
+
+    while (!eof) {
+        ssize_t n = ::read(fd, buffer.data() + filled, buffer.size() - filled);
+        if (n < 0) {
+            std::cerr << "ERROR: cannot read " << filename << std::endl;
+            ::close(fd);
+            return false;
+        }
+        eof = (n == 0);
+        filled += n;
+        if (first_block) {
+            weighted = count_fields(buffer.data(), buffer.data() + filled) == 3;
+            first_block = false;
+        }
+
+        // parse all the complete lines (or everything, at the end of the file)
+        const char *p = buffer.data();
+        const char *end = buffer.data() + filled;
+        const char *last_line = end;
+        if (!eof) {
+            while (last_line > p && *(last_line - 1) != '\n')
+                last_line--;
+            // a single line longer than the buffer: grow it
+            if (last_line == p && filled == buffer.size()) {
+                buffer.resize(buffer.size() * 2);
+                continue;
+            }
+        }
+        while (p < last_line) {
+            const char *nl = (const char *)memchr(p, '\n', last_line - p);
+            const char *line_end = nl ? nl : last_line;
+            uint64_t from, to;
+            float w = 1;
+            if (parse_u64(p, line_end, from) && parse_u64(p, line_end, to)) {
+                if (weighted) parse_float(p, line_end, w);
+                if (from > UINT32_MAX || to > UINT32_MAX) {
+                    std::cerr << "ERROR: vertex id " << std::max(from, to) << " does not fit in 32 bits" << std::endl;
+                    ::close(fd);
+                    return false;
+                }
+                chunk.src.push_back((uint32_t)from);
+                chunk.dst.push_back((uint32_t)to);
+                chunk.weight.push_back(w);
+                if (chunk.size() == chunk_size) {
+                    on_chunk(chunk);
+                    chunk.src.clear();
+                    chunk.dst.clear();
+                    chunk.weight.clear();
+                }
+            }
+            p = nl ? nl + 1 : last_line;
+        }
+        // keep the incomplete line for the next block
+        filled = end - last_line;
+        memmove(buffer.data(), last_line, filled);
+    }
+    if (chunk.size() > 0)
+        on_chunk(chunk);
+    ::close(fd);
+    return true;
+}
+
+bool EdgeList::load(const std::string &graphName, bool undirected) {
+    this->undirected = undirected;
+    chunks.clear();
+    num_file_edges = 0;
+    max_id = 0;
+
+    // distinct vertex ids, as a growing bitmap
+    std::vector<uint64_t> seen;
+    auto mark = [&seen](uint32_t id) {
+        if ((id >> 6) >= seen.size())
+            seen.resize(std::max<uint64_t>((id >> 6) + 1, 2 * seen.size()), 0);
+        seen[id >> 6] |= 1ULL << (id & 63);
+    };
+
+    bool ok = parse_edge_file(graphName + ".e", [&](EdgeChunk &chunk) {
+        for (uint64_t i = 0; i < chunk.size(); i++) {
+            mark(chunk.src[i]);
+            mark(chunk.dst[i]);
+            max_id = std::max<uint64_t>(max_id, std::max(chunk.src[i], chunk.dst[i]));
+        }
+        num_file_edges += chunk.size();
+        // store an exactly sized copy of the chunk
+        chunks.emplace_back();
+        chunks.back().src.assign(chunk.src.begin(), chunk.src.end());
+        chunks.back().dst.assign(chunk.dst.begin(), chunk.dst.end());
+        chunks.back().weight.assign(chunk.weight.begin(), chunk.weight.end());
+    }, weighted);
+
+    num_vertices = 0;
+    for (uint64_t word : seen)
+        num_vertices += __builtin_popcountll(word);
+    return ok;
+}
+
+void EdgeList::assign(std::vector<EdgeChunk> edge_chunks, bool weighted) {
+    chunks = std::move(edge_chunks);
+    undirected = false;
+    this->weighted = weighted;
+    num_file_edges = 0;
+    max_id = 0;
+    std::vector<uint64_t> seen;
+    for (const EdgeChunk &chunk : chunks) {
+        num_file_edges += chunk.size();
+        for (uint64_t i = 0; i < chunk.size(); i++) {
+            uint32_t ids[2] = {chunk.src[i], chunk.dst[i]};
+            for (uint32_t id : ids) {
+                if ((id >> 6) >= seen.size())
+                    seen.resize(std::max<uint64_t>((id >> 6) + 1, 2 * seen.size()), 0);
+                seen[id >> 6] |= 1ULL << (id & 63);
+                max_id = std::max<uint64_t>(max_id, id);
+            }
+        }
+    }
+    num_vertices = 0;
+    for (uint64_t word : seen)
+        num_vertices += __builtin_popcountll(word);
+}
@@ -0,0 +1,105 @@
+#include "../include/GraphSelector.h"
+#include "../include/GraphBuilder.h"
+
+#include <algorithm>
+#include <sstream>
+
+GraphStats compute_graph_stats(const EdgeList &edges) {
+    GraphStats stats;
+    stats.vertices = edges.vertices();
+    stats.edges = edges.size();
+    stats.max_id = edges.max_vertex_id();
+    stats.weighted = edges.is_weighted();
+    stats.undirected = edges.is_undirected();
+    stats.avg_degree = stats.vertices ? (double)stats.edges / stats.vertices : 0;
+    stats.density = stats.vertices > 1 ? (double)stats.edges / ((double)stats.vertices * (stats.vertices - 1)) : 0;
+    // same threshold as HybridGraph, over the same vertex slots
+    uint64_t n = stats.vertices + 2;
+    stats.dense_threshold = n / 64;
+
+    std::vector<uint64_t> offsets(std::max(n, stats.max_id + 1) + 1);
+    count_degrees(edges, offsets.size() - 1, offsets.data());
+    std::vector<uint64_t> degrees;
+    degrees.reserve(stats.vertices);
+    stats.max_degree = stats.dense_vertices = stats.dense_edges = 0;
+    for (uint64_t i = 0; i + 1 < offsets.size(); i++) {
+        uint64_t degree = offsets[i + 1] - offsets[i];
+        if (degree == 0)
+            continue;
+        degrees.push_back(degree);
+        stats.max_degree = std::max(stats.max_degree, degree);
+        if (degree > stats.dense_threshold) {
+            stats.dense_vertices++;
+            stats.dense_edges += degree;
+        }
+    }
+    stats.median_degree = 0;
+    if (!degrees.empty()) {
+        std::nth_element(degrees.begin(), degrees.begin() + degrees.size() / 2, degrees.end());
+        stats.median_degree = degrees[degrees.size() / 2];
+    }
+    return stats;
+}
+
+static std::string to_mb(double bytes) {
+    std::ostringstream out;
+    out << bytes / (1024.0 * 1024.0) << " MB";
+    return out.str();
+}
+
+GraphChoice select_graph_type(const GraphStats &stats, bool allow_hybrid) {
+    GraphChoice choice;
+    std::ostringstream reason;
+
+    // estimated sizes (HybridGraph stores 64-bit ids and double weights for sparse vertices,
+    // a bitmap of all the vertices and double weights for dense ones)
+    uint64_t n = stats.vertices + 2;
+    double adj_bytes = 2.0 * n * 24 + stats.edges * 2.0 * (2 * sizeof(void *) + 8);
+    double csr_bytes = (n + 1) * 8.0 + stats.edges * (stats.weighted ? 8.0 : 4.0);
+    double hybrid_bytes = n * 20.0 + (stats.edges - stats.dense_edges) * 16.0 + stats.dense_edges * 8.0 + stats.dense_vertices * (n / 8.0);
+    double dense_fraction = stats.edges ? (double)stats.dense_edges / stats.edges : 0;
+
+    // below 64 vertices per dense neighborhood a bitmap word filters too few candidates to pay off
+    bool hybrid_pays_off = dense_fraction >= 0.5 && stats.dense_threshold >= 64;
+    if (hybrid_pays_off && allow_hybrid) {
+        choice.type = "hybrid";
+        reason << (int)(dense_fraction * 100) << "% of the edges leave the " << stats.dense_vertices << " vertices with degree > "
+               << stats.dense_threshold << ": their bitmaps let BFS test 64 neighbors per word";
+        choice.reasons.push_back(reason.str());
+        reason.str("");
+        reason << "estimated size " << to_mb(hybrid_bytes) << " (csr: " << to_mb(csr_bytes) << ", adj: " << to_mb(adj_bytes) << ")";
+        choice.reasons.push_back(reason.str());
+        return choice;
+    }
+
+    choice.type = "csr";
+    if (hybrid_pays_off)
+        reason << (int)(dense_fraction * 100) << "% of the edges leave vertices with degree > " << stats.dense_threshold
+               << ", but HybridGraph changes the DFS order and the sums (use -G auto+hybrid to allow it)";
+    else if (stats.dense_threshold >= 64)
+        reason << "sparse graph: average degree " << stats.avg_degree << ", " << (int)(dense_fraction * 100)
+               << "% of the edges leave vertices with degree > " << stats.dense_threshold;
+    else
+        reason << "small graph: " << stats.vertices << " vertices are too few for bitmaps";
+    choice.reasons.push_back(reason.str());
+    if (!stats.weighted)
+        choice.reasons.push_back("unweighted graph: weights are not stored");
+    reason.str("");
+    reason << "estimated size " << to_mb(csr_bytes) << " (hybrid: " << to_mb(hybrid_bytes) << ", adj: " << to_mb(adj_bytes) << ")";
+    choice.reasons.push_back(reason.str());
+    return choice;
+}
+
+void print_graph_stats(std::ostream &out, const GraphStats &stats) {
+    out << "Graph statistics: " << (stats.weighted ? "weighted" : "unweighted") << ", ids up to " << stats.max_id << std::endl;
+    out << "degree: max " << stats.max_degree << ", average " << stats.avg_degree << ", median " << stats.median_degree << std::endl;
+    out << "density: " << stats.density << std::endl;
+    out << "dense vertices (degree > " << stats.dense_threshold << "): " << stats.dense_vertices << ", with " << stats.dense_edges << " edges" << std::endl << std::endl;
+}
+
+void print_graph_choice(std::ostream &out, const GraphChoice &choice) {
+    out << "Selected data structure: " << choice.type << std::endl;
+    for (auto &reason : choice.reasons)
+        out << "  - " << reason << std::endl;
+    out << std::endl;
+}
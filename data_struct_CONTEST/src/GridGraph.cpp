@@ -0,0 +1,133 @@
+#include "../include/GridGraph.h"
+#include "../include/ThreadPool.h"
+
+#include <unistd.h>
+
+GridGraph::GridGraph(uint64_t v, uint64_t e, uint64_t chunk) : v(v), e(e), chunk(chunk), P(0), wide(false),
+    rows(nullptr), row_ends(nullptr), dst(nullptr), weights(nullptr), degrees(nullptr), vertex_offsets(nullptr), vertex_rows(nullptr),
+    num_rows(0), num_edges(0) {
+    if (!this->chunk) {
+        long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        uint64_t cache = l2 > 0 ? (uint64_t)l2 : 1 << 20;
+        // a source and a destination slice of dist (8 bytes per vertex) and used (1 byte)
+        this->chunk = 64;
+        while (this->chunk * 2 * 2 * (sizeof(uint64_t) + sizeof(bool)) <= cache)
+            this->chunk *= 2;
+    }
+}
+
+// edges of the sources of range i to range j, in the order of the csr: two passes over the
+// rows of the grid, counting the sources and edges of every block, then copying them
+template<typename L>
+void GridGraph::fill(const CSRGraph &csr) {
+    ThreadPool &pool = ThreadPool::instance();
+    const uint64_t n = v + 2;
+    std::vector<uint64_t> counts(2 * P * P, 0);     // sources and edges of block b at 2b, 2b + 1
+    pool.parallel_for(0, P, [&](uint64_t i) {
+        std::vector<uint64_t> last(P, UINT64_MAX);
+        for (uint64_t s = i * chunk; s < std::min(n, (i + 1) * chunk); s++)
+            csr.for_each_neighbor(s, [&](uint64_t d, double) {
+                uint64_t j = d / chunk;
+                if (last[j] != s) {
+                    last[j] = s;
+                    counts[2 * (i * P + j)]++;
+                }
+                counts[2 * (i * P + j) + 1]++;
+            });
+    }, 1);
+    for (uint64_t b = 0; b < P * P; b++) {
+        blocks[b].first_row = num_rows;
+        blocks[b].num_rows = counts[2 * b];
+        blocks[b].first_edge = num_edges;
+        num_rows += counts[2 * b];
+        num_edges += counts[2 * b + 1];
+    }
+
+    L *local_rows = new L[num_rows];
+    L *local_dst = new L[num_edges];
+    rows = (char *)local_rows;
+    dst = (char *)local_dst;
+    row_ends = new uint32_t[num_rows];
+    weights = csr.is_weighted() ? new float[num_edges] : nullptr;
+    pool.parallel_for(0, P, [&](uint64_t i) {
+        std::vector<uint64_t> last(P, UINT64_MAX), row(P), edge(P);
+        for (uint64_t j = 0; j < P; j++) {
+            row[j] = blocks[i * P + j].first_row;
+            edge[j] = blocks[i * P + j].first_edge;
+        }
+        for (uint64_t s = i * chunk; s < std::min(n, (i + 1) * chunk); s++)
+            csr.for_each_neighbor(s, [&](uint64_t d, double w) {
+                uint64_t j = d / chunk;
+                if (last[j] != s) {
+                    last[j] = s;
+                    local_rows[row[j]++] = (L)(s - i * chunk);
+                }
+                local_dst[edge[j]] = (L)(d - j * chunk);
+                if (weights)
+                    weights[edge[j]] = (float)w;
+                edge[j]++;
+                row_ends[row[j] - 1] = (uint32_t)(edge[j] - blocks[i * P + j].first_edge);
+            });
+    }, 1);
+}
+
+// rows of every vertex, by column: counted, then listed walking the blocks of each range of
+// sources by column
+template<typename L>
+void GridGraph::index_rows() {
+    ThreadPool &pool = ThreadPool::instance();
+    const uint64_t n = v + 2;
+    const L *local_rows = (const L *)rows;
+    vertex_offsets = new uint64_t[n + 1];
+    vertex_offsets[0] = 0;
+    pool.parallel_for(0, n, [&](uint64_t s) { vertex_offsets[s + 1] = 0; });
+    pool.parallel_for(0, P, [&](uint64_t i) {
+        for (uint64_t b = i * P; b < (i + 1) * P; b++)
+            for (uint64_t k = 0; k < blocks[b].num_rows; k++)
+                vertex_offsets[i * chunk + local_rows[blocks[b].first_row + k] + 1]++;
+    }, 1);
+    for (uint64_t s = 0; s < n; s++)
+        vertex_offsets[s + 1] += vertex_offsets[s];
+    vertex_rows = new RowRef[num_rows];
+    pool.parallel_for(0, P, [&](uint64_t i) {
+        const uint64_t first = i * chunk;
+        std::vector<uint64_t> next(vertex_offsets + first, vertex_offsets + std::min(n, first + chunk));
+        for (uint64_t j = 0; j < P; j++) {
+            const Block &block = blocks[i * P + j];
+            for (uint64_t k = 0; k < block.num_rows; k++)
+                vertex_rows[next[local_rows[block.first_row + k]]++] = RowRef{(uint32_t)j, (uint32_t)k};
+        }
+    }, 1);
+}
+
+void GridGraph::build(const CSRGraph &csr) {
+    const uint64_t n = v + 2;
+    P = (n + chunk - 1) / chunk;
+    wide = chunk > 65536;
+    blocks.assign(P * P, Block());
+    degrees = new uint32_t[n];
+    ThreadPool::instance().parallel_for(0, n, [&](uint64_t i) { degrees[i] = (uint32_t)csr.degree(i); });
+    if (wide) {
+        fill<uint32_t>(csr);
+        index_rows<uint32_t>();
+    } else {
+        fill<uint16_t>(csr);
+        index_rows<uint16_t>();
+    }
+    finished();
+}
+
+// the edges are sorted by source (keeping their order) in a CSR first, then split in blocks
+void GridGraph::populate(std::tuple<uint64_t, uint64_t, double>* e_list){
+    CSRGraph csr(v, e);
+    csr.populate(e_list);
+    build(csr);
+}
+
+void GridGraph::populate(const EdgeList &edges){
+    CSRGraph csr(v, e);
+    csr.populate(edges);
+    build(csr);
+}
+
+void GridGraph::finished() {}
@@ -0,0 +1,80 @@
+#include "../include/HybridGraph.h"
+#include "../include/GraphBuilder.h"
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+
+template<typename Edges>
+void HybridGraph::build(const Edges &edges){
+    ThreadPool &pool = ThreadPool::instance();
+
+    // bucket the edges by source vertex, keeping their order
+    uint64_t *begin = new uint64_t[v + 3];
+    count_degrees(edges, v + 2, begin);
+    std::pair<uint64_t, double> *staged = new std::pair<uint64_t, double>[begin[v + 2]];
+    scatter_edges(edges, v + 2, begin, [staged](uint64_t p, uint64_t to, double weight) {
+        staged[p] = std::make_pair(to, weight);
+    });
+
+    // sort each neighborhood by id (stable, so the first of duplicated edges comes first)
+    // and choose the representation of each vertex; sizes are stored in the offsets for now
+    dense_slot = new uint32_t[v + 2];
+    id_offsets = new uint64_t[v + 3];
+    w_offsets = new uint64_t[v + 3];
+    id_offsets[0] = w_offsets[0] = 0;
+    pool.parallel_for(0, v + 2, [this, begin, staged](uint64_t i) {
+        std::stable_sort(staged + begin[i], staged + begin[i + 1],
+            [](const std::pair<uint64_t, double> &a, const std::pair<uint64_t, double> &b) { return a.first < b.first; });
+        uint64_t degree = begin[i + 1] - begin[i];
+        if(degree > threshold){
+            uint64_t distinct = std::unique(staged + begin[i], staged + begin[i + 1],
+                [](const std::pair<uint64_t, double> &a, const std::pair<uint64_t, double> &b) { return a.first == b.first; }) - (staged + begin[i]);
+            dense_slot[i] = 0;
+            id_offsets[i + 1] = 0;
+            w_offsets[i + 1] = distinct;
+        } else {
+            dense_slot[i] = NOT_DENSE;
+            id_offsets[i + 1] = degree;
+            w_offsets[i + 1] = degree;
+        }
+    });
+    num_dense = 0;
+    for(uint64_t i = 0; i < v + 2; i++){
+        if(is_dense(i))
+            dense_slot[i] = num_dense++;
+        id_offsets[i + 1] += id_offsets[i];
+        w_offsets[i + 1] += w_offsets[i];
+    }
+
+    // fill the sorted arrays and the bitmaps
+    ids = new uint64_t[id_offsets[v + 2]];
+    weights = new double[w_offsets[v + 2]];
+    bitmaps = new uint64_t[num_dense * words]();
+    pool.parallel_for(0, v + 2, [this, begin, staged](uint64_t i) {
+        uint64_t n = w_offsets[i + 1] - w_offsets[i];
+        for(uint64_t j = 0; j < n; j++){
+            const std::pair<uint64_t, double> &edge = staged[begin[i] + j];
+            weights[w_offsets[i] + j] = edge.second;
+            if(is_dense(i))
+                bitmaps[dense_slot[i] * words + (edge.first >> 6)] |= 1ULL << (edge.first & 63);
+            else
+                ids[id_offsets[i] + j] = edge.first;
+        }
+    });
+    delete[] staged;
+    delete[] begin;
+    finished();
+}
+
+void HybridGraph::populate(std::tuple<uint64_t, uint64_t, double>* e_list){
+    build(TupleEdgeList(e_list, e));
+}
+
+void HybridGraph::populate(const EdgeList &edges){
+    build(edges);
+}
+
+// neighbors are always kept sorted by id
+void HybridGraph::sortEdgesByNodeId() {}
+
+void HybridGraph::finished() {}
@@ -0,0 +1,77 @@
+#include "../include/HyperANF.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+// 64-bit mixer of splitmix64
+static inline uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// the first log2m bits of the hash select the register, which keeps the largest position of
+// the first 1 in the remaining bits
+void HyperLogLogCounters::add(uint64_t x, uint64_t item, uint64_t seed) {
+    const uint64_t hash = mix(item ^ mix(seed));
+    const uint64_t rest = hash << log2m;
+    const uint8_t rank = rest ? __builtin_clzll(rest) + 1 : 64 - log2m + 1;
+    uint8_t &reg = (*this)[x][hash >> (64 - log2m)];
+    if (rank > reg)
+        reg = rank;
+}
+
+// raw estimate alpha m^2 / sum of 2^-register, with linear counting on the empty registers for
+// small counts (no correction for large ones is needed with 64-bit hashes)
+double HyperLogLogCounters::estimate(uint64_t x) const {
+    // 2^-r for every register value
+    static const std::vector<double> power = []() {
+        std::vector<double> p(65);
+        for (int r = 0; r <= 64; r++)
+            p[r] = std::ldexp(1.0, -r);
+        return p;
+    }();
+    const uint8_t *counter = (*this)[x];
+    double sum = 0;
+    uint64_t zeros = 0;
+    for (uint64_t j = 0; j < m; j++) {
+        sum += power[counter[j]];
+        zeros += counter[j] == 0;
+    }
+    const double alpha = m == 16 ? 0.673 : m == 32 ? 0.697 : m == 64 ? 0.709 : 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0)
+        estimate = m * std::log((double)m / zeros);
+    return estimate;
+}
+
+double NeighborhoodFunction::effective_diameter(double fraction) const {
+    const double target = fraction * within.back();
+    uint64_t t = 0;
+    while (within[t] < target)
+        t++;
+    if (t == 0)
+        return 0;
+    return (t - 1) + (target - within[t - 1]) / (within[t] - within[t - 1]);
+}
+
+double NeighborhoodFunction::average_distance() const {
+    double sum = 0;
+    for (uint64_t t = 1; t < within.size(); t++)
+        sum += t * pairs(t);
+    return within.back() > within[0] ? sum / (within.back() - within[0]) : 0;
+}
+
+bool NeighborhoodFunction::write(const std::string &filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "ERROR: cannot write " << filename << std::endl;
+        return false;
+    }
+    out.precision(10);
+    for (uint64_t t = 0; t < within.size(); t++)
+        out << t << " " << pairs(t) << " " << within[t] << "\n";
+    return (bool)(out << std::flush);
+}
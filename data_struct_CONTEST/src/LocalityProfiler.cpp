@@ -0,0 +1,181 @@
+#include "../include/LocalityProfiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+thread_local LocalityProfiler *LocalityProfiler::active = nullptr;
+
+static const char *STREAM_NAMES[] = {"used", "dist", "adjacency", "weights", "all"};
+
+// spatial sampling: keep x if its hash falls in 1 of every period (a power of two)
+static inline bool sampled(uint64_t x, uint64_t period) {
+    return (((x * 0x9E3779B97F4A7C15ULL) >> 32) & (period - 1)) == 0;
+}
+
+// smallest power of two >= x / 65536, so that about 64K lines or pages are tracked
+static uint64_t sampling_period(uint64_t x) {
+    uint64_t period = 1;
+    while (period * 65536 < x)
+        period *= 2;
+    return period;
+}
+
+void ReuseTracker::add(uint64_t t, int64_t delta) {
+    for (uint64_t i = t + 1; i < tree.size(); i += i & (~i + 1))
+        tree[i] += delta;
+}
+
+uint64_t ReuseTracker::prefix(uint64_t t) const {
+    int64_t sum = 0;
+    for (uint64_t i = t; i > 0; i -= i & (~i + 1))
+        sum += tree[i];
+    return sum;
+}
+
+void ReuseTracker::access(uint64_t line, uint64_t scale) {
+    // grow the tree, rebuilding it from the marks
+    if (time >= marks.size()) {
+        marks.resize(std::max<uint64_t>(1024, 2 * marks.size()), 0);
+        tree.assign(marks.size() + 1, 0);
+        for (uint64_t t = 0; t < time; t++)
+            if (marks[t])
+                add(t, 1);
+    }
+    auto it = last.find(line);
+    if (it == last.end()) {
+        cold++;
+        last[line] = time;
+    } else {
+        uint64_t distance = (prefix(time) - prefix(it->second + 1)) * scale;
+        uint64_t bucket = distance ? 64 - __builtin_clzll(distance) : 0;
+        if (histogram.size() <= bucket)
+            histogram.resize(bucket + 1, 0);
+        histogram[bucket]++;
+        add(it->second, -1);
+        marks[it->second] = 0;
+        it->second = time;
+    }
+    marks[time] = 1;
+    add(time, 1);
+    time++;
+}
+
+void LocalityProfiler::start(const std::string &traversal, uint64_t footprint) {
+    name = traversal;
+    line_period = sampling_period(footprint / LINE);
+    page_period = sampling_period(footprint / PAGE);
+    for (unsigned s = 0; s <= STREAMS; s++) {
+        accesses[s] = same_line[s] = same_page[s] = 0;
+        previous[s] = UINT64_MAX;
+        reuse[s] = ReuseTracker();
+        level_lines[s].clear();
+    }
+    level_pages.clear();
+    levels.clear();
+    cur_level = 0;
+    levels.push_back(LocalityLevel());
+}
+
+void LocalityProfiler::access(LocalityStream stream, const void *address) {
+    uint64_t a = (uint64_t)address, line = a / LINE, page = a / PAGE;
+    bool sample_line = sampled(line, line_period);
+    unsigned streams[2] = {(unsigned)stream, STREAMS};
+    for (unsigned s : streams) {
+        accesses[s]++;
+        same_line[s] += previous[s] / LINE == line;
+        same_page[s] += previous[s] / PAGE == page;
+        previous[s] = a;
+        if (sample_line) {
+            reuse[s].access(line, line_period);
+            level_lines[s].insert(line);
+        }
+    }
+    if (sampled(page, page_period))
+        level_pages.insert(page);
+    levels.back().accesses++;
+}
+
+void LocalityProfiler::close_level() {
+    LocalityLevel &l = levels.back();
+    for (unsigned s = 0; s <= STREAMS; s++) {
+        l.lines[s] = level_lines[s].size() * line_period;
+        level_lines[s].clear();
+    }
+    l.pages = level_pages.size() * page_period;
+    level_pages.clear();
+}
+
+void LocalityProfiler::level(uint64_t l) {
+    if (l == cur_level)
+        return;
+    close_level();
+    cur_level = l;
+    levels.push_back(LocalityLevel());
+}
+
+void LocalityProfiler::stop() {
+    close_level();
+}
+
+bool LocalityProfiler::write(const std::string &filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "ERROR: cannot write " << filename << std::endl;
+        return false;
+    }
+    out << "# " << name << ": reuse distances and working sets sampled on 1 in " << line_period
+        << " cache lines of " << LINE << " bytes, 1 in " << page_period << " pages of " << PAGE << " bytes" << std::endl;
+    out << "stream,accesses,same_line,same_page" << std::endl;
+    for (unsigned s = 0; s <= STREAMS; s++)
+        out << STREAM_NAMES[s] << "," << accesses[s] << "," << (accesses[s] ? (double)same_line[s] / accesses[s] : 0)
+            << "," << (accesses[s] ? (double)same_page[s] / accesses[s] : 0) << std::endl;
+
+    // reuse distances in [min_lines, max_lines]; "cold" for first accesses
+    out << std::endl << "stream,min_lines,max_lines,samples" << std::endl;
+    for (unsigned s = 0; s <= STREAMS; s++) {
+        const std::vector<uint64_t> &h = reuse[s].histogram;
+        for (uint64_t b = 0; b < h.size(); b++)
+            out << STREAM_NAMES[s] << "," << (b ? 1ULL << (b - 1) : 0) << "," << (b ? (1ULL << b) - 1 : 0) << "," << h[b] << std::endl;
+        out << STREAM_NAMES[s] << ",cold,cold," << reuse[s].cold << std::endl;
+    }
+
+    out << std::endl << "level,accesses,used_lines,dist_lines,adjacency_lines,weights_lines,lines,pages" << std::endl;
+    for (uint64_t l = 0; l < levels.size(); l++) {
+        const LocalityLevel &level = levels[l];
+        out << l << "," << level.accesses;
+        for (unsigned s = 0; s <= STREAMS; s++)
+            out << "," << level.lines[s];
+        out << "," << level.pages << std::endl;
+    }
+    return true;
+}
+
+void LocalityProfiler::print(std::ostream &out) const {
+    const uint64_t caches[] = {32 << 10, 1 << 20, 32 << 20};
+    const char *cache_names[] = {"32 KB", "1 MB", "32 MB"};
+    out << name << " locality (LRU hits sampled on 1 in " << line_period << " lines):" << std::endl;
+    for (unsigned s = 0; s <= STREAMS; s++) {
+        if (!accesses[s])
+            continue;
+        out << "  " << STREAM_NAMES[s] << ": " << accesses[s] << " accesses, same line " << 100.0 * same_line[s] / accesses[s]
+            << "%, same page " << 100.0 * same_page[s] / accesses[s] << "%, LRU hits";
+        const std::vector<uint64_t> &h = reuse[s].histogram;
+        uint64_t samples = reuse[s].cold;
+        for (uint64_t count : h)
+            samples += count;
+        for (unsigned c = 0; c < 3; c++) {
+            // buckets entirely below the capacity in lines
+            uint64_t hits = 0;
+            for (uint64_t b = 0; b < h.size() && (1ULL << b) <= caches[c] / LINE; b++)
+                hits += h[b];
+            out << " " << cache_names[c] << " " << (samples ? 100.0 * hits / samples : 0) << "%";
+        }
+        out << std::endl;
+    }
+    uint64_t peak = 0;
+    for (uint64_t l = 1; l < levels.size(); l++)
+        if (levels[l].lines[STREAMS] > levels[peak].lines[STREAMS])
+            peak = l;
+    out << "  " << levels.size() << " level(s), largest working set " << levels[peak].lines[STREAMS] * LINE / (1024.0 * 1024.0)
+        << " MB (" << levels[peak].pages << " pages) at level " << peak << std::endl;
+}
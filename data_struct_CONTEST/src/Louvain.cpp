@@ -0,0 +1,194 @@
+#include "../include/Louvain.h"
+#include "../include/GraphBuilder.h"
+
+#include <algorithm>
+#include <utility>
+
+// Edge source (community, vertex) for the vertices of a level, by blocks of vertices:
+// scattering it groups the vertices by community, in vertex order
+class CommunityMembers {
+    const std::vector<uint32_t> &comm;
+    uint64_t block_size;
+
+public:
+    explicit CommunityMembers(const std::vector<uint32_t> &comm) : comm(comm), block_size(std::max<uint64_t>(1024, comm.size() / (64 * ThreadPool::instance().size()))) {}
+
+    uint64_t num_blocks() const { return (comm.size() + block_size - 1) / block_size; }
+
+    template<typename F>
+    void for_each_edge_in_block(uint64_t b, F f) const {
+        for (uint64_t i = b * block_size; i < std::min<uint64_t>(comm.size(), (b + 1) * block_size); i++)
+            f(comm[i], i, 1.0);
+    }
+};
+
+// (community, weight) pairs sorted by community, with the weights of each community summed
+static void merge_by_community(std::vector<std::pair<uint32_t, double> > &pairs) {
+    std::sort(pairs.begin(), pairs.end(), [](const std::pair<uint32_t, double> &a, const std::pair<uint32_t, double> &b) {
+        return a.first < b.first;
+    });
+    uint64_t k = 0;
+    for (uint64_t i = 0; i < pairs.size(); i++) {
+        if (k > 0 && pairs[k - 1].first == pairs[i].first)
+            pairs[k - 1].second += pairs[i].second;
+        else
+            pairs[k++] = pairs[i];
+    }
+    pairs.resize(k);
+}
+
+double louvain_modularity(const LouvainLevel &g, const std::vector<uint32_t> &comm, const std::vector<double> &tot) {
+    ThreadPool &pool = ThreadPool::instance();
+    auto plus = [](double a, double b) { return a + b; };
+    double total = pool.parallel_reduce(0, g.size(), 0.0, [&](uint64_t lo, uint64_t hi) {
+        double sum = 0;
+        for (uint64_t x = lo; x < hi; x++)
+            sum += g.degree[x];
+        return sum;
+    }, plus);
+    if (total == 0)
+        return 0;
+    double inner = pool.parallel_reduce(0, g.size(), 0.0, [&](uint64_t lo, uint64_t hi) {
+        double sum = 0;
+        for (uint64_t x = lo; x < hi; x++)
+            for (uint64_t k = g.offsets[x]; k < g.offsets[x + 1]; k++)
+                if (comm[g.ids[k]] == comm[x])
+                    sum += g.weights[k];
+        return sum;
+    }, plus);
+    double expected = pool.parallel_reduce(0, tot.size(), 0.0, [&](uint64_t lo, uint64_t hi) {
+        double sum = 0;
+        for (uint64_t c = lo; c < hi; c++)
+            sum += (tot[c] / total) * (tot[c] / total);
+        return sum;
+    }, plus);
+    return inner / total - expected;
+}
+
+uint64_t louvain_move(const LouvainLevel &g, double threshold, std::vector<uint32_t> &comm, double &modularity) {
+    ThreadPool &pool = ThreadPool::instance();
+    const uint64_t n = g.size();
+    double total = 0;
+    for (uint64_t x = 0; x < n; x++)
+        total += g.degree[x];
+    std::vector<uint32_t> next(n), target(n), size(n, 1);
+    std::vector<double> tot(g.degree);
+    comm.resize(n);
+    pool.parallel_for(0, n, [&](uint64_t x) { comm[x] = (uint32_t)x; });
+    modularity = louvain_modularity(g, comm, tot);
+
+    const uint64_t batches = std::min<uint64_t>(n, LOUVAIN_BATCHES);
+    while (total > 0) {
+        std::copy(comm.begin(), comm.end(), next.begin());
+        for (uint64_t b = 0; b < batches; b++) {
+            const uint64_t first = b * n / batches, last = (b + 1) * n / batches;
+            pool.parallel_for_range(first, last, [&](uint64_t lo, uint64_t hi) {
+                std::vector<std::pair<uint32_t, double> > pairs;
+                for (uint64_t x = lo; x < hi; x++) {
+                    // weight towards each neighboring community, x itself excluded
+                    pairs.clear();
+                    for (uint64_t k = g.offsets[x]; k < g.offsets[x + 1]; k++)
+                        if (g.ids[k] != x)
+                            pairs.push_back(std::make_pair(next[g.ids[k]], g.weights[k]));
+                    merge_by_community(pairs);
+
+                    // gain of joining c, once x is taken out of its community: w(x, c) - deg(x) tot(c) / 2m
+                    const uint32_t own = next[x];
+                    const double scale = g.degree[x] / total;
+                    double best_gain = -scale * (tot[own] - g.degree[x]);
+                    uint32_t best = own;
+                    for (auto &p : pairs)
+                        if (p.first == own)
+                            best_gain += p.second;
+                    for (auto &p : pairs) {
+                        double gain = p.second - scale * tot[p.first];
+                        if (p.first != own && gain > best_gain) {
+                            best_gain = gain;
+                            best = p.first;
+                        }
+                    }
+                    if (size[own] == 1 && size[best] == 1 && best > own)
+                        best = own;
+                    target[x] = best;
+                }
+            });
+            for (uint64_t x = first; x < last; x++)
+                if (target[x] != next[x]) {
+                    tot[next[x]] -= g.degree[x];
+                    size[next[x]]--;
+                    tot[target[x]] += g.degree[x];
+                    size[target[x]]++;
+                    next[x] = target[x];
+                }
+        }
+
+        double moved = louvain_modularity(g, next, tot);
+        if (moved - modularity < threshold) {
+            if (moved > modularity) {
+                comm.swap(next);
+                modularity = moved;
+            }
+            break;
+        }
+        comm.swap(next);
+        modularity = moved;
+    }
+
+    // renumber the communities in order of their smallest vertex
+    std::vector<uint32_t> id(n, UINT32_MAX);
+    uint32_t communities = 0;
+    for (uint64_t x = 0; x < n; x++) {
+        if (id[comm[x]] == UINT32_MAX)
+            id[comm[x]] = communities++;
+        comm[x] = id[comm[x]];
+    }
+    return communities;
+}
+
+LouvainLevel louvain_coarsen(const LouvainLevel &g, const std::vector<uint32_t> &comm, uint64_t communities) {
+    ThreadPool &pool = ThreadPool::instance();
+    // members[member_offsets[c]..member_offsets[c+1]) = vertices of community c
+    CommunityMembers edges(comm);
+    std::vector<uint64_t> member_offsets(communities + 1);
+    std::vector<uint32_t> members(g.size());
+    count_degrees(edges, communities, member_offsets.data());
+    scatter_edges(edges, communities, member_offsets.data(), [&members](uint64_t p, uint64_t x, double) {
+        members[p] = (uint32_t)x;
+    });
+
+    // rows of ranges of communities, each merged into its own chunk, then copied in place
+    LouvainLevel next;
+    next.offsets.assign(communities + 1, 0);
+    next.degree.resize(communities);
+    const uint64_t num_chunks = std::max<uint64_t>(1, std::min<uint64_t>(communities, 8 * pool.size()));
+    std::vector<std::vector<std::pair<uint32_t, double> > > chunks(num_chunks);
+    pool.parallel_for(0, num_chunks, [&](uint64_t k) {
+        std::vector<std::pair<uint32_t, double> > pairs;
+        for (uint64_t c = k * communities / num_chunks; c < (k + 1) * communities / num_chunks; c++) {
+            pairs.clear();
+            for (uint64_t m = member_offsets[c]; m < member_offsets[c + 1]; m++)
+                for (uint64_t e = g.offsets[members[m]]; e < g.offsets[members[m] + 1]; e++)
+                    pairs.push_back(std::make_pair(comm[g.ids[e]], g.weights[e]));
+            merge_by_community(pairs);
+            double degree = 0;
+            for (auto &p : pairs)
+                degree += p.second;
+            next.degree[c] = degree;
+            next.offsets[c + 1] = pairs.size();
+            chunks[k].insert(chunks[k].end(), pairs.begin(), pairs.end());
+        }
+    }, 1);
+    for (uint64_t c = 0; c < communities; c++)
+        next.offsets[c + 1] += next.offsets[c];
+    next.ids.resize(next.offsets[communities]);
+    next.weights.resize(next.offsets[communities]);
+    pool.parallel_for(0, num_chunks, [&](uint64_t k) {
+        uint64_t p = next.offsets[k * communities / num_chunks];
+        for (auto &pair : chunks[k]) {
+            next.ids[p] = pair.first;
+            next.weights[p++] = pair.second;
+        }
+        std::vector<std::pair<uint32_t, double> >().swap(chunks[k]);
+    }, 1);
+    return next;
+}
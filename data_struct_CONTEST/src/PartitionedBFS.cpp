@@ -0,0 +1,293 @@
+#include "../include/PartitionedBFS.h"
+#include "../include/GraphBuilder.h"
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <climits>
+#include <csignal>
+#include <iostream>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// header of the exchange segment, followed by the arrays of PartitionedBFS
+struct PartitionedBFS::Exchange {
+    pthread_barrier_t barrier;
+    uint64_t num_levels;
+};
+
+// a frontier candidate for another partition
+struct PartitionedBFS::Message {
+    uint32_t target;
+    uint32_t parent;
+    float weight;
+};
+
+// segments are laid out in cache line aligned arrays
+static inline uint64_t align(uint64_t size) { return (size + 63) & ~(uint64_t)63; }
+
+SharedMemory::~SharedMemory() {
+    if (base) {
+        munmap(base, size);
+        shm_unlink(name.c_str());
+    }
+}
+
+bool SharedMemory::create(const std::string &name, uint64_t size) {
+    this->name = name;
+    this->size = std::max<uint64_t>(size, 1);
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "ERROR: cannot create shared memory " << name << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, this->size) < 0) {
+        std::cerr << "ERROR: cannot allocate " << this->size << " bytes of shared memory" << std::endl;
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *p = mmap(nullptr, this->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "ERROR: cannot map shared memory " << name << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+    base = p;
+    return true;
+}
+
+PartitionedBFS::PartitionedBFS(const EdgeList &edges, uint64_t num_vertices, unsigned num_procs) :
+    n(num_vertices), m(edges.size()), num_procs((unsigned)std::max<uint64_t>(1, std::min<uint64_t>(num_procs, num_vertices))),
+    offsets(nullptr), ids(nullptr), weights(nullptr), dist(nullptr), exchange(nullptr) {
+    chunk = (n + this->num_procs - 1) / this->num_procs;
+    const unsigned P = this->num_procs;
+    std::string prefix = "/hpgda_bfs_" + std::to_string(getpid());
+
+    // graph segment: CSR of all the partitions, plus the distances
+    if (!graph_shm.create(prefix + "_graph", align((n + 1) * sizeof(uint64_t)) + align(n * sizeof(uint64_t)) + 2 * align(m * sizeof(uint32_t))))
+        return;
+    char *g = graph_shm.data();
+    offsets = (uint64_t *)g;
+    g += align((n + 1) * sizeof(uint64_t));
+    dist = (uint64_t *)g;
+    g += align(n * sizeof(uint64_t));
+    ids = (uint32_t *)g;
+    g += align(m * sizeof(uint32_t));
+    weights = (float *)g;
+    count_degrees(edges, n, offsets);
+    scatter_edges(edges, n, offsets, [this](uint64_t p, uint64_t to, double weight) {
+        ids[p] = (uint32_t)to;
+        weights[p] = (float)weight;
+    });
+
+    // mailbox capacities: a process sends every vertex of another partition at most once,
+    // and never more than the edges pointing there
+    std::vector<uint64_t> cross(P * P, 0);
+    ThreadPool::instance().parallel_for(0, P, [&](uint64_t p) {
+        for (uint64_t x = std::min(n, p * chunk); x < std::min(n, (p + 1) * chunk); x++)
+            for (uint64_t i = offsets[x]; i < offsets[x + 1]; i++)
+                cross[p * P + owner(ids[i])]++;
+    }, 1);
+    std::vector<uint64_t> begin(P * P);
+    uint64_t capacity = 0;
+    for (unsigned p = 0; p < P; p++)
+        for (unsigned q = 0; q < P; q++) {
+            begin[p * P + q] = capacity;
+            if (p != q)
+                capacity += std::min(cross[p * P + q], std::min(n, (q + 1) * chunk) - std::min(n, q * chunk));
+        }
+
+    // exchange segment: barrier, mailboxes, per-process counters and per-level statistics
+    uint64_t size = align(sizeof(Exchange)) + 2 * align(P * P * sizeof(uint64_t)) + align(2 * P * sizeof(uint64_t)) + align(P * sizeof(double)) +
+        align((n + 1) * sizeof(LevelStats)) + align(capacity * sizeof(Message));
+    if (!exchange_shm.create(prefix + "_exchange", size))
+        return;
+    char *x = exchange_shm.data();
+    Exchange *header = (Exchange *)x;
+    x += align(sizeof(Exchange));
+    box_begin = (uint64_t *)x;
+    x += align(P * P * sizeof(uint64_t));
+    box_count = (uint64_t *)x;
+    x += align(P * P * sizeof(uint64_t));
+    received = (uint64_t *)x;
+    frontier_size = received + P;
+    x += align(2 * P * sizeof(uint64_t));
+    partial_sum = (double *)x;
+    x += align(P * sizeof(double));
+    stats = (LevelStats *)x;
+    x += align((n + 1) * sizeof(LevelStats));
+    messages = (Message *)x;
+    std::copy(begin.begin(), begin.end(), box_begin);
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&header->barrier, &attr, P);
+    pthread_barrierattr_destroy(&attr);
+    exchange = header;
+}
+
+PartitionedBFS::~PartitionedBFS() {
+    if (exchange)
+        pthread_barrier_destroy(&exchange->barrier);
+}
+
+void PartitionedBFS::run_process(unsigned p, uint64_t source) {
+    const unsigned P = num_procs;
+    const uint64_t lo = std::min(n, p * chunk), hi = std::min(n, (p + 1) * chunk);
+    // smallest parent of every owned vertex in the previous level, and weight of its edge
+    std::vector<uint32_t> parent(hi - lo, UINT32_MAX);
+    std::vector<float> parent_weight(hi - lo, 0);
+    // vertices of other partitions already sent
+    std::vector<uint64_t> sent((n + 63) / 64, 0);
+    std::vector<uint64_t> frontier, next;
+
+    for (uint64_t i = lo; i < hi; i++)
+        dist[i] = LONG_MAX;
+    if (source >= lo && source < hi) {
+        dist[source] = 0;
+        frontier.push_back(source);
+    }
+    uint64_t frontier_total = 1;
+    pthread_barrier_wait(&exchange->barrier);
+
+    for (uint64_t level = 0;; level++) {
+        // expand the frontier by increasing id, so that the first parent found is the smallest
+        std::sort(frontier.begin(), frontier.end());
+        uint64_t *count = box_count + p * P;
+        std::fill(count, count + P, 0);
+        next.clear();
+        for (uint64_t u : frontier) {
+            for (uint64_t i = offsets[u]; i < offsets[u + 1]; i++) {
+                uint64_t t = ids[i];
+                if (t >= lo && t < hi) {
+                    if (dist[t] == (uint64_t)LONG_MAX) {
+                        dist[t] = level + 1;
+                        parent[t - lo] = u;
+                        parent_weight[t - lo] = weights[i];
+                        next.push_back(t);
+                    }
+                } else if (!(sent[t >> 6] & (1ULL << (t & 63)))) {
+                    sent[t >> 6] |= 1ULL << (t & 63);
+                    unsigned q = owner(t);
+                    Message &msg = messages[box_begin[p * P + q] + count[q]++];
+                    msg.target = t;
+                    msg.parent = u;
+                    msg.weight = weights[i];
+                }
+            }
+        }
+        pthread_barrier_wait(&exchange->barrier);
+
+        // receive the candidates sent by the other partitions
+        uint64_t messages_in = 0;
+        for (unsigned q = 0; q < P; q++) {
+            if (q == p)
+                continue;
+            const Message *box = messages + box_begin[q * P + p];
+            for (uint64_t i = 0; i < box_count[q * P + p]; i++) {
+                uint64_t t = box[i].target;
+                if (dist[t] == (uint64_t)LONG_MAX) {
+                    dist[t] = level + 1;
+                    parent[t - lo] = box[i].parent;
+                    parent_weight[t - lo] = box[i].weight;
+                    next.push_back(t);
+                } else if (dist[t] == level + 1 && box[i].parent < parent[t - lo]) {
+                    parent[t - lo] = box[i].parent;
+                    parent_weight[t - lo] = box[i].weight;
+                }
+            }
+            messages_in += box_count[q * P + p];
+        }
+        received[p] = messages_in;
+        frontier_size[p] = next.size();
+        pthread_barrier_wait(&exchange->barrier);
+
+        uint64_t level_messages = 0, next_total = 0;
+        for (unsigned q = 0; q < P; q++) {
+            level_messages += received[q];
+            next_total += frontier_size[q];
+        }
+        if (p == 0) {
+            stats[level].frontier = frontier_total;
+            stats[level].messages = level_messages;
+            stats[level].bytes = level_messages * sizeof(Message);
+            exchange->num_levels = level + 1;
+        }
+        frontier_total = next_total;
+        frontier.swap(next);
+        if (frontier_total == 0)
+            break;
+    }
+
+    double sum = 0;
+    for (uint64_t i = lo; i < hi; i++)
+        if (dist[i] != 0 && dist[i] != (uint64_t)LONG_MAX)
+            sum += parent_weight[i - lo];
+    partial_sum[p] = sum;
+}
+
+bool PartitionedBFS::bfs(uint64_t source, double &sum) {
+    if (!ready())
+        return false;
+    if (source >= n) {
+        std::cerr << "ERROR: source vertex " << source << " out of range" << std::endl;
+        return false;
+    }
+    exchange->num_levels = 0;
+    std::vector<pid_t> children;
+    bool ok = true;
+    for (unsigned p = 0; p < num_procs; p++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_process(p, source);
+            _exit(0);
+        }
+        if (pid < 0) {
+            std::cerr << "ERROR: cannot fork the BFS processes" << std::endl;
+            ok = false;
+            break;
+        }
+        children.push_back(pid);
+    }
+    // the others would wait forever at the barrier if one of the processes is missing
+    if (!ok)
+        for (pid_t pid : children)
+            kill(pid, SIGKILL);
+    for (uint64_t remaining = children.size(); remaining > 0; remaining--) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+            break;
+        if (std::find(children.begin(), children.end(), pid) == children.end()) {
+            remaining++;
+            continue;
+        }
+        if (ok && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+            std::cerr << "ERROR: a BFS process failed" << std::endl;
+            ok = false;
+            for (pid_t other : children)
+                kill(other, SIGKILL);
+        }
+    }
+    if (!ok) {
+        // the barrier may be left in an inconsistent state
+        pthread_barrier_destroy(&exchange->barrier);
+        pthread_barrierattr_t attr;
+        pthread_barrierattr_init(&attr);
+        pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_barrier_init(&exchange->barrier, &attr, num_procs);
+        pthread_barrierattr_destroy(&attr);
+        return false;
+    }
+
+    levels.assign(stats, stats + exchange->num_levels);
+    sum = 0;
+    for (unsigned p = 0; p < num_procs; p++)
+        sum += partial_sum[p];
+    return true;
+}
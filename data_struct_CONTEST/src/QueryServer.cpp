@@ -0,0 +1,80 @@
+#include "../include/QueryServer.h"
+
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+bool LineReader::next(std::string &line) {
+    while (true) {
+        const char *nl = (const char *)memchr(buffer.data() + begin, '\n', end - begin);
+        if (nl) {
+            line.assign(buffer.data() + begin, nl - (buffer.data() + begin));
+            begin = nl - buffer.data() + 1;
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            return true;
+        }
+        // move the partial line to the front, growing the buffer if it is full
+        memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+        if (end == buffer.size())
+            buffer.resize(buffer.size() * 2);
+        ssize_t got = ::read(fd, buffer.data() + end, buffer.size() - end);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0) {
+            // last line without '\n'
+            if (end == 0)
+                return false;
+            line.assign(buffer.data(), end);
+            end = 0;
+            return true;
+        }
+        end += got;
+    }
+}
+
+bool write_line(int fd, const std::string &line) {
+    std::string data = line + "\n";
+    const char *p = data.data();
+    size_t size = data.size();
+    while (size > 0) {
+        ssize_t written = ::write(fd, p, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0)
+            return false;
+        p += written;
+        size -= written;
+    }
+    return true;
+}
+
+int listen_unix(const std::string &path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "ERROR: socket path " << path << " is too long" << std::endl;
+        return -1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "ERROR: cannot create a socket" << std::endl;
+        return -1;
+    }
+    ::unlink(path.c_str());
+    // clients can make the server write files: restrict the socket to its owner before listening
+    if (::bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || ::chmod(path.c_str(), 0600) < 0 || ::listen(fd, 64) < 0) {
+        std::cerr << "ERROR: cannot listen on " << path << std::endl;
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool valid_result_name(const std::string &name) {
+    return !name.empty() && name.find('/') == std::string::npos && name.find("..") == std::string::npos;
+}
@@ -0,0 +1,233 @@
+#include "../include/ResultWriter.h"
+#include "../include/ThreadPool.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char BINARY_MAGIC[8] = {'H', 'P', 'G', 'D', 'A', 'B', 'I', 'N'};
+static const char COMPRESSED_MAGIC[8] = {'H', 'P', 'G', 'D', 'A', 'V', 'Z', '1'};
+
+// below this size a single thread formats everything
+static const uint64_t MIN_VALUES_PER_THREAD = 1 << 16;
+
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// decimal formatting of an unsigned value, two digits at a time; returns the new end
+static inline char *format_u64(char *out, uint64_t x) {
+    char tmp[20];
+    char *p = tmp + 20;
+    while (x >= 100) {
+        uint64_t r = x % 100;
+        x /= 100;
+        p -= 2;
+        memcpy(p, DIGIT_PAIRS + 2 * r, 2);
+    }
+    if (x >= 10) {
+        p -= 2;
+        memcpy(p, DIGIT_PAIRS + 2 * x, 2);
+    } else {
+        *--p = (char)('0' + x);
+    }
+    size_t len = tmp + 20 - p;
+    memcpy(out, p, len);
+    return out + len;
+}
+
+static inline char *encode_varint(char *out, uint64_t x) {
+    while (x >= 0x80) {
+        *out++ = (char)((x & 0x7f) | 0x80);
+        x >>= 7;
+    }
+    *out++ = (char)x;
+    return out;
+}
+
+// format values[lo..hi) into buf according to format
+static void format_range(ResultFormat format, const uint64_t *values, uint64_t lo, uint64_t hi, std::vector<char> &buf) {
+    if (format == ResultFormat::TEXT) {
+        // 20 digits + ' ' + 20 digits + '\n'
+        buf.resize((hi - lo) * 42);
+        char *p = buf.data();
+        for (uint64_t i = lo; i < hi; i++) {
+            p = format_u64(p, i);
+            *p++ = ' ';
+            p = format_u64(p, values[i]);
+            *p++ = '\n';
+        }
+        buf.resize(p - buf.data());
+    } else if (format == ResultFormat::BINARY) {
+        buf.resize((hi - lo) * sizeof(uint64_t));
+        memcpy(buf.data(), values + lo, buf.size());
+    } else {
+        buf.resize((hi - lo) * 10);
+        char *p = buf.data();
+        for (uint64_t i = lo; i < hi; i++)
+            p = encode_varint(p, (values[i] == (uint64_t)LONG_MAX) ? 0 : values[i] + 1);
+        buf.resize(p - buf.data());
+    }
+}
+
+// format the scores values[lo..hi) as text lines into buf
+static void format_scores(const double *values, uint64_t lo, uint64_t hi, std::vector<char> &buf) {
+    // 20 digits + ' ' + at most 24 characters of %.10g + '\n'
+    buf.resize((hi - lo) * 48);
+    char *p = buf.data();
+    for (uint64_t i = lo; i < hi; i++) {
+        p = format_u64(p, i);
+        *p++ = ' ';
+        p += snprintf(p, 26, "%.10g", values[i]);
+        *p++ = '\n';
+    }
+    buf.resize(p - buf.data());
+}
+
+static bool write_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0)
+            return false;
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+ResultWriter::ResultWriter(ResultFormat format, unsigned num_threads) : format(format), num_threads(num_threads) {
+    if (this->num_threads == 0)
+        this->num_threads = ThreadPool::instance().size();
+}
+
+std::string ResultWriter::path(const std::string &filename) const {
+    if (format == ResultFormat::BINARY)
+        return filename + ".bin";
+    if (format == ResultFormat::COMPRESSED)
+        return filename + ".vz";
+    return filename;
+}
+
+void ResultWriter::write_file(const std::string &filename, const uint64_t *values, uint64_t n) {
+    uint64_t threads = std::min<uint64_t>(num_threads, std::max<uint64_t>(1, n / MIN_VALUES_PER_THREAD));
+    std::vector<std::vector<char>> buffers(threads);
+
+    // each task formats a contiguous slice of the values into its own buffer
+    uint64_t chunk = (n + threads - 1) / threads;
+    ThreadPool::instance().parallel_for(0, threads, [&](uint64_t t) {
+        format_range(format, values, std::min(n, t * chunk), std::min(n, (t + 1) * chunk), buffers[t]);
+    }, 1);
+
+    int fd = ::open(path(filename).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "ERROR: cannot open " << path(filename) << std::endl;
+        return;
+    }
+    bool ok = true;
+    if (format != ResultFormat::TEXT) {
+        ok = write_all(fd, (format == ResultFormat::BINARY) ? BINARY_MAGIC : COMPRESSED_MAGIC, 8);
+        ok = ok && write_all(fd, (const char *)&n, sizeof(n));
+    }
+    for (auto &buf : buffers)
+        ok = ok && write_all(fd, buf.data(), buf.size());
+    if (!ok)
+        std::cerr << "ERROR: cannot write " << path(filename) << std::endl;
+    ::close(fd);
+}
+
+void ResultWriter::write_scores(const std::string &filename, const double *values, uint64_t n) {
+    wait();
+    uint64_t threads = std::min<uint64_t>(num_threads, std::max<uint64_t>(1, n / MIN_VALUES_PER_THREAD));
+    std::vector<std::vector<char>> buffers(threads);
+    uint64_t chunk = (n + threads - 1) / threads;
+    ThreadPool::instance().parallel_for(0, threads, [&](uint64_t t) {
+        format_scores(values, std::min(n, t * chunk), std::min(n, (t + 1) * chunk), buffers[t]);
+    }, 1);
+
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "ERROR: cannot open " << filename << std::endl;
+        return;
+    }
+    bool ok = true;
+    for (auto &buf : buffers)
+        ok = ok && write_all(fd, buf.data(), buf.size());
+    if (!ok)
+        std::cerr << "ERROR: cannot write " << filename << std::endl;
+    ::close(fd);
+}
+
+void ResultWriter::write(const std::string &filename, const uint64_t *values, uint64_t n) {
+    wait();
+    write_file(filename, values, n);
+}
+
+void ResultWriter::write_async(const std::string &filename, const uint64_t *values, uint64_t n) {
+    wait();
+    pending.assign(values, values + n);
+    worker = std::thread([this, filename]() { write_file(filename, pending.data(), pending.size()); });
+}
+
+void ResultWriter::wait() {
+    if (worker.joinable())
+        worker.join();
+}
+
+std::vector<uint64_t> ResultWriter::read(const std::string &filename) {
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<uint64_t> values;
+
+    bool binary = data.size() >= 16 && memcmp(data.data(), BINARY_MAGIC, 8) == 0;
+    bool compressed = data.size() >= 16 && memcmp(data.data(), COMPRESSED_MAGIC, 8) == 0;
+    if (binary || compressed) {
+        uint64_t n;
+        memcpy(&n, data.data() + 8, sizeof(n));
+        values.resize(n);
+        const char *p = data.data() + 16;
+        if (binary) {
+            memcpy(values.data(), p, std::min<uint64_t>(n * sizeof(uint64_t), data.size() - 16));
+        } else {
+            const char *end = data.data() + data.size();
+            for (uint64_t i = 0; i < n && p < end; i++) {
+                uint64_t x = 0;
+                int shift = 0;
+                while (p < end && (*p & 0x80)) {
+                    x |= (uint64_t)(*p++ & 0x7f) << shift;
+                    shift += 7;
+                }
+                if (p < end)
+                    x |= (uint64_t)(*p++) << shift;
+                values[i] = (x == 0) ? (uint64_t)LONG_MAX : x - 1;
+            }
+        }
+        return values;
+    }
+
+    // text format: "vertex value" lines
+    const char *p = data.data();
+    const char *end = p + data.size();
+    while (p < end) {
+        uint64_t idx = 0, val = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+            idx = idx * 10 + (*p++ - '0');
+        while (p < end && *p == ' ')
+            p++;
+        while (p < end && *p >= '0' && *p <= '9')
+            val = val * 10 + (*p++ - '0');
+        while (p < end && *p != '\n')
+            p++;
+        if (p < end)
+            p++;
+        if (idx >= values.size())
+            values.resize(idx + 1, (uint64_t)LONG_MAX);
+        values[idx] = val;
+    }
+    return values;
+}
@@ -0,0 +1,47 @@
+#include "../include/Subgraph.h"
+
+#include <fstream>
+#include <iostream>
+#include <random>
+
+bool Subgraph::write(const std::string &graphName) const {
+    std::ofstream v(graphName + ".v"), e(graphName + ".e"), map(graphName + ".map");
+    if (!v || !e || !map) {
+        std::cerr << "ERROR: cannot write " << graphName << ".v/.e/.map" << std::endl;
+        return false;
+    }
+    for (uint64_t i = 0; i < original.size(); i++) {
+        v << i << "\n";
+        map << i << " " << original[i] << "\n";
+    }
+    const bool weighted = edges.is_weighted();
+    edges.for_each_edge([&](uint64_t from, uint64_t to, double weight) {
+        e << from << " " << to;
+        if (weighted)
+            e << " " << weight;
+        e << "\n";
+    });
+    return (bool)(v << std::flush) && (bool)(e << std::flush) && (bool)(map << std::flush);
+}
+
+std::vector<uint64_t> random_vertices(uint64_t n, uint64_t count, uint64_t seed) {
+    std::vector<uint64_t> sample;
+    if (count >= n) {
+        for (uint64_t i = 0; i < n; i++)
+            sample.push_back(i);
+        return sample;
+    }
+    // for j = n - count .. n - 1, add a random t in [0, j], or j itself if t was already taken
+    std::mt19937_64 rng(seed);
+    std::unordered_set<uint64_t> taken;
+    for (uint64_t j = n - count; j < n; j++) {
+        uint64_t t = std::uniform_int_distribution<uint64_t>(0, j)(rng);
+        if (!taken.insert(t).second) {
+            taken.insert(j);
+            t = j;
+        }
+        sample.push_back(t);
+    }
+    std::sort(sample.begin(), sample.end());
+    return sample;
+}
@@ -0,0 +1,134 @@
+#include "../include/ThreadPool.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+std::unique_ptr<ThreadPool> ThreadPool::global;
+
+// index of the deque owned by the current thread, for the pool it belongs to
+static thread_local const ThreadPool *worker_pool = nullptr;
+static thread_local unsigned worker_id = 0;
+
+static void pin_current_thread(unsigned cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+ThreadPool::ThreadPool(unsigned num_threads, bool pin) : num_threads(num_threads), queued(0), stop(false) {
+    if (this->num_threads == 0)
+        this->num_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < this->num_threads; i++)
+        workers.emplace_back(new Worker());
+    // deque 0 belongs to the threads outside the pool, which also run tasks while waiting
+    if (pin)
+        pin_current_thread(0);
+    for (unsigned i = 1; i < this->num_threads; i++)
+        threads.emplace_back(&ThreadPool::worker_loop, this, i, pin);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto &t : threads)
+        t.join();
+}
+
+ThreadPool &ThreadPool::instance() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        if (!global)
+            global.reset(new ThreadPool());
+    });
+    return *global;
+}
+
+void ThreadPool::configure(unsigned num_threads, bool pin) {
+    global.reset(new ThreadPool(num_threads, pin));
+}
+
+unsigned ThreadPool::current_worker() const {
+    return (worker_pool == this) ? worker_id : 0;
+}
+
+uint64_t ThreadPool::local_tasks() {
+    Worker &w = *workers[current_worker()];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    return w.tasks.size();
+}
+
+void ThreadPool::spawn(TaskGroup &group, std::function<void()> task) {
+    group.pending++;
+    queued++;
+    Worker &w = *workers[current_worker()];
+    {
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.tasks.push_back([&group, task]() {
+            task();
+            group.pending--;
+        });
+    }
+    // taking the lock orders the notification after a sleeper's check of queued
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    wake.notify_one();
+}
+
+bool ThreadPool::find_task(std::function<void()> &task) {
+    unsigned self = current_worker();
+    // newest task of the own deque first
+    {
+        Worker &w = *workers[self];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.tasks.empty()) {
+            task = std::move(w.tasks.back());
+            w.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    // otherwise steal the oldest (i.e. largest) task of another worker
+    for (unsigned k = 1; k < num_threads; k++) {
+        Worker &w = *workers[(self + k) % num_threads];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.tasks.empty()) {
+            task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::wait(TaskGroup &group) {
+    std::function<void()> task;
+    while (group.pending > 0) {
+        if (find_task(task))
+            task();
+        else
+            std::this_thread::yield();
+    }
+}
+
+void ThreadPool::worker_loop(unsigned id, bool pin) {
+    worker_pool = this;
+    worker_id = id;
+    if (pin)
+        pin_current_thread(id);
+    std::function<void()> task;
+    while (true) {
+        if (find_task(task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        if (stop)
+            return;
+        if (queued == 0)
+            wake.wait(lock);
+    }
+}
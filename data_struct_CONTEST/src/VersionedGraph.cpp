@@ -0,0 +1,224 @@
+#include "../include/VersionedGraph.h"
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+thread_local VersionedGraph::Pinned VersionedGraph::pinned = {nullptr, nullptr};
+
+EpochManager::EpochManager() : epoch(1) {
+    for (unsigned s = 0; s < SLOTS; s++)
+        slots[s].epoch = 0;
+}
+
+unsigned EpochManager::enter() {
+    while (true) {
+        uint64_t e = epoch.load();
+        for (unsigned s = 0; s < SLOTS; s++) {
+            uint64_t expected = 0;
+            if (slots[s].epoch.load(std::memory_order_relaxed) == 0 && slots[s].epoch.compare_exchange_strong(expected, e))
+                return s;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void EpochManager::leave(unsigned slot) {
+    slots[slot].epoch.store(0);
+}
+
+void EpochManager::retire(std::function<bool()> reclaim) {
+    // the object is unlinked: readers entering from the next epoch on cannot reach it
+    uint64_t e = epoch.fetch_add(1);
+    std::lock_guard<std::mutex> lock(mutex);
+    retired.push_back(std::make_pair(e, std::move(reclaim)));
+}
+
+uint64_t EpochManager::collect() {
+    uint64_t oldest = UINT64_MAX;
+    for (unsigned s = 0; s < SLOTS; s++) {
+        uint64_t e = slots[s].epoch.load();
+        if (e)
+            oldest = std::min(oldest, e);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    retired.erase(std::remove_if(retired.begin(), retired.end(), [oldest](std::pair<uint64_t, std::function<bool()> > &r) {
+        return r.first < oldest && r.second();
+    }), retired.end());
+    return retired.size();
+}
+
+// block of the vertices [first, first + BLOCK) with the neighbors given by visit(x, f)
+template<typename Visit>
+static std::shared_ptr<const AdjacencyBlock> make_block(uint64_t first, uint64_t n, Visit visit) {
+    std::shared_ptr<AdjacencyBlock> block = std::make_shared<AdjacencyBlock>();
+    block->offsets.assign(1, 0);
+    for (uint64_t x = first; x < first + VersionedGraph::BLOCK; x++) {
+        if (x < n)
+            visit(x, [&block](uint64_t to, double weight) {
+                block->ids.push_back((uint32_t)to);
+                block->weights.push_back((float)weight);
+            });
+        block->offsets.push_back((uint32_t)block->ids.size());
+    }
+    return block;
+}
+
+// copy of block with the edges of additions (local vertex, neighbor, weight), sorted by local
+// vertex: appended to the neighbors of each vertex, or merged by id if sorted (stable)
+static std::shared_ptr<const AdjacencyBlock> updated_block(const AdjacencyBlock &block,
+        const std::vector<std::tuple<uint64_t, uint64_t, float> > &additions, bool sorted) {
+    std::shared_ptr<AdjacencyBlock> next = std::make_shared<AdjacencyBlock>();
+    next->offsets.assign(1, 0);
+    next->ids.reserve(block.ids.size() + additions.size());
+    next->weights.reserve(block.ids.size() + additions.size());
+    auto add = additions.begin();
+    auto push = [&next](uint64_t id, float weight) {
+        next->ids.push_back((uint32_t)id);
+        next->weights.push_back(weight);
+    };
+    for (uint64_t i = 0; i + 1 < block.offsets.size(); i++) {
+        uint32_t k = block.offsets[i];
+        const uint32_t k_end = block.offsets[i + 1];
+        auto end = add;
+        while (end != additions.end() && std::get<0>(*end) == i)
+            end++;
+        // old neighbors first on equal ids
+        if (sorted) {
+            for (; k < k_end && add != end; ) {
+                if (block.ids[k] <= std::get<1>(*add))
+                    push(block.ids[k], block.weights[k]), k++;
+                else
+                    push(std::get<1>(*add), std::get<2>(*add)), add++;
+            }
+        }
+        for (; k < k_end; k++)
+            push(block.ids[k], block.weights[k]);
+        for (; add != end; add++)
+            push(std::get<1>(*add), std::get<2>(*add));
+        next->offsets.push_back((uint32_t)next->ids.size());
+    }
+    return next;
+}
+
+VersionedGraph::~VersionedGraph() {
+    epochs.collect();
+    delete current.load();
+}
+
+VersionedGraph::Snapshot VersionedGraph::snapshot() {
+    // the epoch keeps the current version alive until the reference is taken
+    unsigned slot = epochs.enter();
+    const GraphVersion *version = current.load();
+    version->readers.fetch_add(1);
+    epochs.leave(slot);
+    return Snapshot(this, version);
+}
+
+void VersionedGraph::release(const GraphVersion *version) {
+    if (version->readers.fetch_sub(1) == 1 && version != current.load())
+        epochs.collect();
+}
+
+bool VersionedGraph::apply(const std::vector<std::tuple<uint64_t, uint64_t, double> > &batch, uint64_t *number, uint64_t *edges) {
+    for (auto &edge : batch)
+        if (std::get<0>(edge) >= v + 2 || std::get<1>(edge) >= v + 2) {
+            std::cerr << "ERROR: edge " << std::get<0>(edge) << " -> " << std::get<1>(edge) << " out of the vertex range" << std::endl;
+            return false;
+        }
+    std::lock_guard<std::mutex> lock(writer);
+    const GraphVersion *old = current.load();
+    GraphVersion *next = new GraphVersion();
+    next->number = old->number + 1;
+    next->edges = old->edges + batch.size();
+    if (number)
+        *number = next->number;
+    if (edges)
+        *edges = next->edges;
+    next->out = old->out;
+    next->in = old->in;
+
+    // (vertex, neighbor, weight) by block, then by vertex (and neighbor for in-edges), keeping the batch order
+    for (int direction = 0; direction < 2; direction++) {
+        std::vector<std::tuple<uint64_t, uint64_t, float> > edges;
+        for (auto &edge : batch)
+            edges.push_back(direction == 0 ? std::make_tuple(std::get<0>(edge), std::get<1>(edge), (float)std::get<2>(edge))
+                                           : std::make_tuple(std::get<1>(edge), std::get<0>(edge), (float)std::get<2>(edge)));
+        std::stable_sort(edges.begin(), edges.end(), [direction](const std::tuple<uint64_t, uint64_t, float> &a, const std::tuple<uint64_t, uint64_t, float> &b) {
+            return std::get<0>(a) != std::get<0>(b) ? std::get<0>(a) < std::get<0>(b) : direction == 1 && std::get<1>(a) < std::get<1>(b);
+        });
+        std::vector<std::shared_ptr<const AdjacencyBlock> > &blocks = direction == 0 ? next->out : next->in;
+        for (uint64_t i = 0; i < edges.size();) {
+            const uint64_t b = std::get<0>(edges[i]) / BLOCK;
+            std::vector<std::tuple<uint64_t, uint64_t, float> > additions;
+            for (; i < edges.size() && std::get<0>(edges[i]) / BLOCK == b; i++)
+                additions.push_back(std::make_tuple(std::get<0>(edges[i]) % BLOCK, std::get<1>(edges[i]), std::get<2>(edges[i])));
+            blocks[b] = updated_block(*blocks[b], additions, direction == 1);
+        }
+    }
+
+    current.store(next);
+    epochs.retire([old]() {
+        if (old->readers.load())
+            return false;
+        delete old;
+        return true;
+    });
+    epochs.collect();
+    return true;
+}
+
+void VersionedGraph::add_edges(uint64_t from, std::vector<uint64_t> &to, std::vector<double> &weights) {
+    std::vector<std::tuple<uint64_t, uint64_t, double> > batch;
+    for (uint64_t i = 0; i < to.size(); i++)
+        batch.push_back(std::make_tuple(from, to[i], i < weights.size() ? weights[i] : 1.0));
+    apply(batch);
+}
+
+uint64_t VersionedGraph::size_in_bytes() const {
+    const GraphVersion &g = version();
+    uint64_t size = sizeof(GraphVersion) + (g.out.size() + g.in.size()) * sizeof(std::shared_ptr<const AdjacencyBlock>);
+    for (auto &block : g.out)
+        size += block->size_in_bytes();
+    return size + reverse_index_size_in_bytes();
+}
+
+uint64_t VersionedGraph::reverse_index_size_in_bytes() const {
+    uint64_t size = 0;
+    for (auto &block : version().in)
+        size += block->size_in_bytes();
+    return size;
+}
+
+// the blocks of version 0 are cut from a CSR and its transpose, in parallel
+void VersionedGraph::build(CSRGraph &csr) {
+    const uint64_t n = v + 2, blocks = (n + BLOCK - 1) / BLOCK;
+    GraphVersion *version = new GraphVersion();
+    version->out.resize(blocks);
+    version->in.resize(blocks);
+    if (n > 0)
+        csr.in_degree(0);
+    ThreadPool::instance().parallel_for(0, blocks, [&](uint64_t b) {
+        version->out[b] = make_block(b * BLOCK, n, [&csr](uint64_t x, std::function<void(uint64_t, double)> f) { csr.for_each_neighbor(x, f); });
+        version->in[b] = make_block(b * BLOCK, n, [&csr](uint64_t x, std::function<void(uint64_t, double)> f) { csr.for_each_in_neighbor(x, f); });
+    }, 1);
+    for (uint64_t x = 0; x < n; x++)
+        version->edges += csr.degree(x);
+    delete current.load();
+    current.store(version);
+}
+
+void VersionedGraph::populate(std::tuple<uint64_t, uint64_t, double>* e_list){
+    CSRGraph csr(v, e);
+    csr.populate(e_list);
+    build(csr);
+}
+
+void VersionedGraph::populate(const EdgeList &edges){
+    CSRGraph csr(v, e);
+    csr.populate(edges);
+    build(csr);
+}
+
+void VersionedGraph::finished() {}
@@ -1,88 +1,251 @@
 #include "../include/utils.h"
 #include "../include/AdjacencyList.h"
+#include "../include/HybridGraph.h"
+#include "../include/CSRGraph.h"
+#include "../include/GridGraph.h"
+#include "../include/EdgeList.h"
 #include "../include/GraphAlgorithm.h"
+#include "../include/GraphSelector.h"
+#include "../include/PartitionedBFS.h"
+#include "../include/QueryServer.h"
+#include "../include/ResultWriter.h"
+#include "../include/ThreadPool.h"
+#include "../include/VersionedGraph.h"
+#include <cmath>
 #include <fstream>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
+// betweenness centrality on graph: spec is "bc" (all the sources), "bc:k" (k random sources)
+// or "bc=s1,s2,..." (the given sources), out of the n ids in [0, v]; sampled scores are scaled
+// by n / k, and halved on undirected graphs (every pair is counted from both ends). Returns a
+// description of the result, with the normalised largest score and its error bound if sampled
+template<typename T>
+std::string run_betweenness(GraphAlgorithm<T> &graph, const std::string &spec, bool undirected) {
+    const uint64_t n = graph.num_vertices() + 1;
+    std::vector<uint64_t> sources;
+    if (spec.size() > 3 && spec[2] == ':') {
+        sources = sample_sources(n, std::stoul(spec.substr(3)), 42);
+    } else if (spec.size() > 3 && spec[2] == '=') {
+        std::istringstream list(spec.substr(3));
+        std::string id;
+        while (std::getline(list, id, ','))
+            sources.push_back(std::stoul(id));
+    }
+    uint64_t k = sources.empty() ? n : sources.size();
+    double scale = (double)n / k * (undirected ? 0.5 : 1);
+    graph.betweenness(sources, scale);
 
-int main(int argc, char **argv) {
-    // argv[1] -> graph name (required)
-    // argv[2] -> source vertex for BFS and DFS (required)
-    // argv[3] -> number of iterations (required)
-    // argv[4 or 5] -> -U (if undirected graph, default: directed graph)
-    // argv[4 or 5] -> -d (if debugging, default: no debug)
+    const std::vector<double> &bc = graph.score_results();
+    uint64_t top = std::max_element(bc.begin(), bc.end()) - bc.begin();
+    std::ostringstream result;
+    // normalised by the number of pairs (unordered on undirected graphs)
+    double pairs = (double)n * (n - 1) * (undirected ? 0.5 : 1);
+    result << "largest betweenness " << bc[top] << " (vertex " << top << ", normalised " << bc[top] / pairs << "), " << k << " source(s)";
+    if (k < n)
+        result << ", normalised error of each vertex at most " << betweenness_error(n, k, 0.95) << " with probability 0.95";
+    return result.str();
+}
 
-    // variables to measure memory usage
-    double vm_usage = 0.0, resident_set_size = 0.0;
-    double vm_tmp = 0.0, rss_tmp = 0.0;
+// pagerank on graph, with damping 0.85: spec is "pr" (until the L1 change is below 1e-9, at most
+// 100 iterations), "pr:n" (n iterations) or "pr=epsilon" (until the L1 change is below epsilon).
+// Returns a description of the result
+template<typename T>
+std::string run_pagerank(GraphAlgorithm<T> &graph, const std::string &spec) {
+    uint64_t iterations = 100;
+    double epsilon = 1e-9;
+    if (spec.size() > 3 && spec[2] == ':')
+        iterations = std::stoul(spec.substr(3)), epsilon = 0;
+    else if (spec.size() > 3 && spec[2] == '=')
+        epsilon = std::stod(spec.substr(3));
+    double delta = 0;
+    iterations = graph.pagerank(0.85, iterations, epsilon, delta);
 
-    // vertex stored in graphName.v
-    // edges stored in graphName.e
-    std::string graphName = argv[1];
+    const std::vector<double> &pr = graph.score_results();
+    uint64_t top = std::max_element(pr.begin(), pr.end()) - pr.begin();
+    std::ostringstream result;
+    result << "largest rank " << pr[top] << " (vertex " << top << "), " << iterations << " iteration(s), last L1 change " << delta;
+    return result.str();
+}
 
-    // get source vertex from command arguments
-    uint64_t src_vertex, num_iterations;
-    if (argc <= 3){
-        std::cout << "ERROR: missing required arguments!" << std::endl; 
-        std::cout << "USAGE: bin/exe path/to/graph num_iterations\nOptions:\n\t-U\tfor undirected graphs\n\t-d\tfor debugging" << std::endl; 
-        return 1;
+// louvain communities of graph: spec is "louvain" (levels and sweeps go on while modularity
+// rises by at least 1e-6) or "louvain=threshold". Returns a description of the result
+template<typename T>
+std::string run_louvain(GraphAlgorithm<T> &graph, const std::string &spec, bool undirected) {
+    double threshold = 1e-6;
+    if (spec.size() > 8 && spec[7] == '=')
+        threshold = std::stod(spec.substr(8));
+    uint64_t levels = 0;
+    double modularity = graph.louvain(undirected, threshold, levels);
+
+    const uint64_t *community = graph.results();
+    uint64_t n = graph.num_vertices() + 2, communities = 0;
+    for (uint64_t x = 0; x < n; x++)
+        communities += community[x] == x;
+    std::ostringstream result;
+    result << communities << " communities, modularity " << modularity << ", " << levels << " level(s)";
+    return result.str();
+}
+
+// approximate neighborhood function of graph with HyperANF: spec is "anf" (64 registers per
+// counter) or "anf:b" (2^b registers, b in [4, 16]); the distance distribution is written in
+// graphName.anf.dist. Returns a description of the result
+template<typename T>
+std::string run_anf(GraphAlgorithm<T> &graph, const std::string &spec, const std::string &graphName) {
+    unsigned log2m = 6;
+    if (spec.size() > 4 && spec[3] == ':')
+        log2m = std::min(16UL, std::max(4UL, std::stoul(spec.substr(4))));
+    NeighborhoodFunction anf = graph.anf(log2m, 42);
+    anf.write(graphName + ".anf.dist");
+
+    const std::vector<double> &harmonic = graph.score_results();
+    uint64_t top = std::max_element(harmonic.begin(), harmonic.end()) - harmonic.begin();
+    std::ostringstream result;
+    result << "effective diameter " << anf.effective_diameter() << ", average distance " << anf.average_distance()
+           << ", " << anf.within.back() << " reachable pairs within " << anf.diameter() << " hops, largest harmonic centrality "
+           << harmonic[top] << " (vertex " << top << "), relative standard error " << 1.04 / std::sqrt((double)(1 << log2m));
+    return result.str();
+}
+
+// run the analytics kernel on graph, writing its per-vertex results in graphName.<kernel>
+template<typename T>
+void run_kernel(GraphAlgorithm<T> &graph, const std::string &kernel, const std::string &graphName, bool debug, bool undirected, ResultWriter &writer) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    std::ostringstream result;
+    std::string name = kernel;
+    if (kernel == "scc") {
+        result << graph.scc() << " strongly connected components";
+    } else if (kernel == "kcore") {
+        result << "largest core number " << graph.kcore();
+    } else if (kernel.compare(0, 2, "bc") == 0 && (kernel.size() == 2 || kernel[2] == ':' || kernel[2] == '=')) {
+        name = "bc";
+        result << run_betweenness(graph, kernel, undirected);
+    } else if (kernel.compare(0, 2, "pr") == 0 && (kernel.size() == 2 || kernel[2] == ':' || kernel[2] == '=')) {
+        name = "pr";
+        result << run_pagerank(graph, kernel);
+    } else if (kernel.compare(0, 7, "louvain") == 0 && (kernel.size() == 7 || kernel[7] == '=')) {
+        name = "louvain";
+        result << run_louvain(graph, kernel, undirected);
+    } else if (kernel.compare(0, 3, "anf") == 0 && (kernel.size() == 3 || kernel[3] == ':')) {
+        name = "anf";
+        result << run_anf(graph, kernel, graphName);
     } else {
-        src_vertex = std::stoul(std::string(argv[2]));
-        num_iterations = std::stoul(std::string(argv[3]));
+        std::cerr << "ERROR: unknown kernel " << kernel << std::endl;
+        return;
     }
-    
-    // default: directed graph
-    // default: debugging inactive
-    bool undirected = false;
-    bool debug = false;
-    if (argc > 4){
-        undirected = (std::string(argv[4]) == "-U") ? true : false; 
-        debug = (std::string(argv[4]) == "-d") ? true : false; 
-        if (argc > 5){
-            if (!undirected) undirected = (std::string(argv[5]) == "-U") ? true : false;
-            if (!debug) debug = (std::string(argv[5]) == "-d") ? true : false;
-        } 
+    auto end = std::chrono::high_resolution_clock::now();
+    bool scores = name == "bc" || name == "pr" || name == "anf";
+    if (scores)
+        graph.write_scores(writer, graphName + "." + name);
+    else
+        graph.write_results_async(writer, graphName + "." + name);
+    if(debug){
+        std::cout << name << " execution time: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms" << std::endl;
+        std::cout << name << " result: " << result.str() << std::endl;
+        std::cout << name << " results written in " << (scores ? graphName + "." + name : writer.path(graphName + "." + name)) << std::endl << std::endl;
     }
+}
 
-    // get number of edges
-    uint64_t e = count_lines(graphName + ".e");
-    // no self-loop allowed: each undirected edge = 2 directed edges
-    if (undirected) e *= 2;
-
-    // get memory usage before loading the graph
-    process_mem_usage(vm_usage, resident_set_size, false);
+// write the locality profile of the last bfs/dfs in graphName.<traversal>.locality
+// (only in the instrumentation build, see make profile)
+template<typename T>
+void write_locality(GraphAlgorithm<T> &graph, const std::string &graphName, bool debug) {
+    const LocalityProfiler &profile = graph.locality_profile();
+    if (profile.empty())
+        return;
+    std::string filename = graphName + "." + profile.traversal() + ".locality";
+    if (!profile.write(filename))
+        return;
+    if(debug){
+        profile.print(std::cout);
+        std::cout << "Locality profile written in " << filename << std::endl << std::endl;
+    }
+}
 
-    // temporary data structs for nodes and edges
-    std::tuple<uint64_t, uint64_t, double>* edges = new std::tuple<uint64_t, uint64_t, double>[e];
-    std::set<uint64_t> nodes;
+// extract a subgraph of graph and write it in graphName.sub.{v,e,map}: spec is "khop:k:s1,s2,..."
+// (vertices within k hops of the seeds) or "sample:count" (count random vertices)
+template<typename T>
+void run_extract(GraphAlgorithm<T> &graph, const std::string &spec, const std::string &graphName, bool debug) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    std::vector<uint64_t> vertices;
+    std::istringstream fields(spec);
+    std::string kind, field;
+    std::getline(fields, kind, ':');
+    if (kind == "khop" && std::getline(fields, field, ':')) {
+        uint64_t k = std::stoul(field);
+        std::vector<uint64_t> seeds;
+        while (std::getline(fields, field, ','))
+            seeds.push_back(std::stoul(field));
+        vertices = graph.neighborhood(seeds, k);
+    } else if (kind == "sample" && std::getline(fields, field)) {
+        vertices = random_vertices(graph.num_vertices() + 2, std::stoul(field), 42);
+    } else {
+        std::cerr << "ERROR: unknown subgraph " << spec << std::endl;
+        return;
+    }
+    Subgraph sub = graph.subgraph(vertices);
+    auto end = std::chrono::high_resolution_clock::now();
+    if (!sub.write(graphName + ".sub"))
+        return;
+    if(debug){
+        std::cout << "Subgraph extraction time: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms" << std::endl;
+        std::cout << "Subgraph: " << sub.size() << " vertices, " << sub.edges.size() << " edges, written in " << graphName << ".sub.{v,e,map}" << std::endl << std::endl;
+    }
+}
 
-    // read nodes and edges
-    if(debug) std::cout << "Loading the graph " << graphName << std::endl;
-    nodes = load_graph(graphName, undirected, edges, e);
-    if(debug) std::cout << "Graph loaded!" << std::endl << std::endl;
+// edges of the input graph traversed by a bfs/dfs that reached the vertices with dist < LONG_MAX
+// (n entries): as in Graph500, the edges of the file leaving a reached vertex, each undirected edge
+// counted once
+uint64_t traversed_edges(const EdgeList &edges, const uint64_t *dist, uint64_t n) {
+    const std::vector<EdgeChunk> &chunks = edges.get_chunks();
+    const bool undirected = edges.is_undirected();
+    return ThreadPool::instance().parallel_reduce(0, chunks.size(), (uint64_t)0, [&](uint64_t lo, uint64_t hi) {
+        uint64_t count = 0;
+        for (uint64_t c = lo; c < hi; c++)
+            for (uint64_t i = 0; i < chunks[c].size(); i++) {
+                uint64_t s = chunks[c].src[i], d = chunks[c].dst[i];
+                count += (s < n && dist[s] != (uint64_t)LONG_MAX) || (undirected && d < n && dist[d] != (uint64_t)LONG_MAX);
+            }
+        return count;
+    }, [](uint64_t a, uint64_t b) { return a + b; }, 1);
+}
 
-    // get increment in memory usage after loading the graph
-    process_mem_usage(vm_usage, resident_set_size, true);
-    if(debug) std::cout << "Edge list size: " << resident_set_size/1024 << " MB" << std::endl << std::endl;
+// traversed edges per second
+template<typename D>
+double teps(uint64_t traversed, D elapsed) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? traversed / seconds : 0;
+}
 
-    // get number of nodes
-    uint64_t v = nodes.size();
-    
-    // print graph info
-    if(debug) print_graph_info(v, e, undirected);
+// print the counters of the last bfs/dfs (only in the counters build, see make counters)
+void print_counters(const std::string &traversal, const TraversalCounters &counters) {
+    if (counters.vertices == 0)
+        return;
+    std::cout << traversal << " counters: " << counters.edges << " edges scanned, " << counters.vertices << " vertices visited, "
+        << counters.redundant << " redundant visited checks" << std::endl;
+    if (!counters.frontier.empty()) {
+        std::cout << traversal << " frontier per level:";
+        for (uint64_t size : counters.frontier)
+            std::cout << " " << size;
+        std::cout << std::endl;
+    }
+}
 
-    // print edges
-    // if(debug) print_edge_list(edges, e);
+// instantiate, populate and traverse the graph num_iterations times,
+// using T as graph data structure
+template<typename T>
+void run_iterations(std::string graphName, uint64_t src_vertex, uint64_t num_iterations, bool debug,
+                    const EdgeList &edges, uint64_t v, uint64_t e, const std::vector<std::string> &kernels, bool frontier_bfs,
+                    const std::string &extract, ResultWriter &writer, double vm_usage, double resident_set_size) {
+    double vm_tmp = 0.0, rss_tmp = 0.0;
 
-    // get memory usage before instantiating and populating the graph
-    process_mem_usage(vm_usage, resident_set_size, false);
-    
     for(uint64_t i = 0; i < num_iterations; i++){
 
         if(debug) std::cout << "Iteration " << i+1 << std::endl << std::endl;
         // instantiate the graph
-        auto *graph = new GraphAlgorithm<AdjacencyList>(v,e);
+        auto *graph = new GraphAlgorithm<T>(v,e);
         
         // populate the graph and measure time
         auto begin_populate = std::chrono::high_resolution_clock::now();
@@ -107,48 +270,314 @@ int main(int argc, char **argv) {
         
         // execute bfs and measure time
         auto begin_bfs = std::chrono::high_resolution_clock::now();
-        result = graph->bfs(src_vertex);
+        result = frontier_bfs ? graph->bfs_frontier(src_vertex) : graph->bfs(src_vertex);
         auto end_bfs = std::chrono::high_resolution_clock::now();
         auto elapsed_bfs = std::chrono::duration_cast<std::chrono::milliseconds>(end_bfs - begin_bfs);
+        uint64_t traversed = traversed_edges(edges, graph->results(), v + 2);
+        double bfs_teps = teps(traversed, end_bfs - begin_bfs);
         if(debug) {
             std::cout << "BFS execution time: " << elapsed_bfs.count() << " ms" << std::endl;
-            std::cout << "BFS sum: " << result << std::endl << std::endl;
+            std::cout << "BFS sum: " << result << std::endl;
+            std::cout << "BFS TEPS: " << bfs_teps << " (" << traversed << " edges traversed)" << std::endl;
+            print_counters("BFS", graph->counters());
+            std::cout << std::endl;
         } else {
             std::cout << elapsed_bfs.count() << "," << result << ",";
         }
         // write results of the BFS (just at the 1st iteration)
         if(i == 0){
-            graph->write_results(graphName + ".bfs");
+            graph->write_results_async(writer, graphName + ".bfs");
             if(debug){
                 std::cout << "Writing BFS results..." << std::endl;
-                std::cout << "BFS results written in " << graphName + ".bfs" << std::endl << std::endl;
+                std::cout << "BFS results written in " << writer.path(graphName + ".bfs") << std::endl << std::endl;
             }
+            write_locality(*graph, graphName, debug);
         }
         // execute dfs and measure time
         auto begin_dfs = std::chrono::high_resolution_clock::now();
         result = graph->dfs(src_vertex);
         auto end_dfs = std::chrono::high_resolution_clock::now();
         auto elapsed_dfs = std::chrono::duration_cast<std::chrono::milliseconds>(end_dfs - begin_dfs);
+        traversed = traversed_edges(edges, graph->results(), v + 2);
+        double dfs_teps = teps(traversed, end_dfs - begin_dfs);
         if(debug) {
             std::cout << "DFS execution time: " << elapsed_dfs.count() << " ms" << std::endl;
-            std::cout << "DFS sum: " << result << std::endl << std::endl;
+            std::cout << "DFS sum: " << result << std::endl;
+            std::cout << "DFS TEPS: " << dfs_teps << " (" << traversed << " edges traversed)" << std::endl;
+            print_counters("DFS", graph->counters());
+            std::cout << std::endl;
         } else {
-            std::cout << elapsed_dfs.count() << "," << result << std::endl;
+            std::cout << elapsed_dfs.count() << "," << result << "," << bfs_teps << "," << dfs_teps << std::endl;
         }
         // write results of the DFS (just at the 1st iteration)
         if(i == 0){
-            graph->write_results(graphName + ".dfs");
+            graph->write_results_async(writer, graphName + ".dfs");
             if(debug){
                 std::cout << "Writing DFS results..." << std::endl;
-                std::cout << "DFS results written in " << graphName + ".dfs" << std::endl << std::endl;
+                std::cout << "DFS results written in " << writer.path(graphName + ".dfs") << std::endl << std::endl;
             }
+            write_locality(*graph, graphName, debug);
+        }
+        // run the other kernels (just at the 1st iteration), writing graphName.<kernel>
+        if(i == 0){
+            for (auto &kernel : kernels)
+                run_kernel(*graph, kernel, graphName, debug, edges.is_undirected(), writer);
+            if (!extract.empty())
+                run_extract(*graph, extract, graphName, debug);
+        }
+        if(debug){
+            std::cout << "Data structure size: " << graph->size_in_bytes() / (1024.0 * 1024.0) << " MB";
+            std::cout << " (reverse index: " << graph->reverse_index_size_in_bytes() / (1024.0 * 1024.0) << " MB)" << std::endl << std::endl;
         }
         // free memory
         delete graph;
     }
+}
+
+// partition the graph across num_procs processes and run the partitioned BFS num_iterations times
+// (CSV: src,populate_ms,mem_mb,bfs_ms,bfs_sum,levels,messages,comm_mb,bfs_teps); the distances and the
+// communication per level of the first iteration are written in graphName.bfs and graphName.comm
+int run_partitioned(std::string graphName, uint64_t src_vertex, uint64_t num_iterations, bool debug,
+                    const EdgeList &edges, uint64_t v, unsigned num_procs,
+                    ResultWriter &writer, double vm_usage, double resident_set_size) {
+    double vm_tmp = 0.0, rss_tmp = 0.0;
+
+    for(uint64_t i = 0; i < num_iterations; i++){
+
+        if(debug) std::cout << "Iteration " << i+1 << std::endl << std::endl;
+        // copy the graph in shared memory, partitioned by vertex range
+        auto begin_populate = std::chrono::high_resolution_clock::now();
+        PartitionedBFS graph(edges, std::max(v + 2, edges.max_vertex_id() + 1), num_procs);
+        auto end_populate = std::chrono::high_resolution_clock::now();
+        if (!graph.ready())
+            return 1;
+        auto elapsed_populate = std::chrono::duration_cast<std::chrono::milliseconds>(end_populate - begin_populate);
+        vm_tmp = vm_usage;
+        rss_tmp = resident_set_size;
+        process_mem_usage(vm_tmp, rss_tmp, true);
+        if(debug) {
+            std::cout << "Graph population time: " << elapsed_populate.count() << " ms (" << graph.processes() << " partitions)" << std::endl << std::endl;
+            std::cout << "Graph size: " << rss_tmp/1024 << " MB" << std::endl << std::endl;
+        } else {
+            std::cout << src_vertex << "," << elapsed_populate.count() << "," << rss_tmp/1024 << ",";
+        }
+
+        // execute the partitioned bfs and measure time
+        double result = -1;
+        auto begin_bfs = std::chrono::high_resolution_clock::now();
+        if (!graph.bfs(src_vertex, result))
+            return 1;
+        auto end_bfs = std::chrono::high_resolution_clock::now();
+        auto elapsed_bfs = std::chrono::duration_cast<std::chrono::milliseconds>(end_bfs - begin_bfs);
+        uint64_t messages = 0, bytes = 0;
+        for (auto &level : graph.level_stats())
+            messages += level.messages, bytes += level.bytes;
+        uint64_t traversed = traversed_edges(edges, graph.distances(), v + 2);
+        double bfs_teps = teps(traversed, end_bfs - begin_bfs);
+        if(debug) {
+            std::cout << "BFS execution time: " << elapsed_bfs.count() << " ms" << std::endl;
+            std::cout << "BFS sum: " << result << std::endl;
+            std::cout << "BFS TEPS: " << bfs_teps << " (" << traversed << " edges traversed)" << std::endl;
+            for (uint64_t l = 0; l < graph.level_stats().size(); l++) {
+                const LevelStats &level = graph.level_stats()[l];
+                std::cout << "Level " << l << ": frontier " << level.frontier << ", " << level.messages << " messages, " << level.bytes << " bytes" << std::endl;
+            }
+            std::cout << std::endl;
+        } else {
+            std::cout << elapsed_bfs.count() << "," << result << "," << graph.level_stats().size() << "," << messages << "," << bytes / (1024.0 * 1024.0) << "," << bfs_teps << std::endl;
+        }
+        // write results of the BFS and communication volume (just at the 1st iteration)
+        if(i == 0){
+            writer.write(graphName + ".bfs", graph.distances(), v + 1);
+            std::ofstream comm(graphName + ".comm");
+            comm << "level,frontier,messages,bytes" << std::endl;
+            for (uint64_t l = 0; l < graph.level_stats().size(); l++)
+                comm << l << "," << graph.level_stats()[l].frontier << "," << graph.level_stats()[l].messages << "," << graph.level_stats()[l].bytes << std::endl;
+            if(debug){
+                std::cout << "BFS results written in " << writer.path(graphName + ".bfs") << std::endl;
+                std::cout << "Communication per level written in " << graphName << ".comm" << std::endl << std::endl;
+            }
+        }
+    }
+    return 0;
+}
+
+// build the graph once, then answer the queries on stdin or on socket_path (if not empty),
+// writing the result files they ask for in output_dir
+template<typename T>
+int run_server(const EdgeList &edges, uint64_t v, uint64_t e, ResultFormat format, const std::string &socket_path,
+               const std::string &output_dir, bool debug) {
+    GraphAlgorithm<T> graph(v, e);
+    auto begin_populate = std::chrono::high_resolution_clock::now();
+    graph.populate(edges);
+    auto end_populate = std::chrono::high_resolution_clock::now();
+    if(debug)
+        std::cerr << "Graph population time: " << std::chrono::duration_cast<std::chrono::milliseconds>(end_populate - begin_populate).count() << " ms" << std::endl;
+
+    QueryServer<T> server(graph, format, output_dir, edges.is_undirected());
+    if (socket_path.empty()) {
+        server.serve_stdin();
+        return 0;
+    }
+    if(debug) std::cerr << "Listening on " << socket_path << std::endl;
+    return server.serve_socket(socket_path) ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    // argv[1] -> graph name (required)
+    // argv[2] -> source vertex for BFS and DFS (required)
+    // argv[3] -> number of iterations (required)
+    // argv[4 or 5] -> -U (if undirected graph, default: directed graph)
+    // argv[4 or 5] -> -d (if debugging, default: no debug)
+    // argv[4+] -> -b (binary result files) or -z (compressed result files), default: text
+    // argv[4+] -> -G adj|csr|hybrid|grid|versioned|auto|auto+hybrid (graph data structure, default: adj;
+    //             auto: selected from the statistics of the graph, auto+hybrid: HybridGraph allowed too)
+    // argv[4+] -> -t num_threads (default: one per hardware thread), -p (pin threads to CPUs)
+    // -s (serve queries on stdin) or -S socket_path (serve queries on a Unix socket):
+    //    the graph is built once, source vertex and iterations are not needed
+    //    -o output_dir: directory of the result files written by the queries (default: .)
+    // argv[4+] -> -a kernel (run an analytics kernel at the 1st iteration, writing graphName.kernel;
+    //             can be repeated): scc, kcore, bc (betweenness: bc, bc:k for k random sources,
+    //             bc=s1,s2,... for the given sources), pr (pagerank: pr, pr:n for n iterations,
+    //             pr=epsilon for an L1 convergence threshold), louvain (communities: louvain,
+    //             louvain=threshold for the least modularity gain), anf (HyperANF: anf, anf:b
+    //             for 2^b registers per counter)
+    // argv[4+] -> -F (BFS with the frontier engine, edge_map of Frontier.h)
+    // argv[4+] -> -X khop:k:s1,s2,...|sample:count (extract a subgraph at the 1st iteration,
+    //             writing graphName.sub.v, .e and .map)
+    // argv[4+] -> -M num_procs (BFS partitioned across num_procs processes sharing memory)
+
+    // variables to measure memory usage
+    double vm_usage = 0.0, resident_set_size = 0.0;
+
+    // vertex stored in graphName.v
+    // edges stored in graphName.e
+    std::string graphName = argc > 1 ? argv[1] : "";
+
+    // default: directed graph
+    // default: debugging inactive
+    // default: text result files
+    // default: AdjacencyList
+    bool undirected = false;
+    bool debug = false;
+    ResultFormat format = ResultFormat::TEXT;
+    std::string graphType = "adj";
+    unsigned num_threads = 0;
+    bool pin_threads = false;
+    bool server = false;
+    bool frontier_bfs = false;
+    unsigned num_procs = 0;
+    std::vector<std::string> kernels;
+    std::string extract;
+    std::string socket_path;
+    std::string output_dir = ".";
+    std::vector<std::string> positional;
+    for (int arg = 2; arg < argc; arg++){
+        std::string opt(argv[arg]);
+        if (opt == "-U") undirected = true;
+        else if (opt == "-d") debug = true;
+        else if (opt == "-b") format = ResultFormat::BINARY;
+        else if (opt == "-z") format = ResultFormat::COMPRESSED;
+        else if (opt == "-G" && arg + 1 < argc) graphType = argv[++arg];
+        else if (opt == "-t" && arg + 1 < argc) num_threads = std::stoul(std::string(argv[++arg]));
+        else if (opt == "-p") pin_threads = true;
+        else if (opt == "-s") server = true;
+        else if (opt == "-S" && arg + 1 < argc) server = true, socket_path = argv[++arg];
+        else if (opt == "-o" && arg + 1 < argc) output_dir = argv[++arg];
+        else if (opt == "-a" && arg + 1 < argc) kernels.push_back(argv[++arg]);
+        else if (opt == "-F") frontier_bfs = true;
+        else if (opt == "-X" && arg + 1 < argc) extract = argv[++arg];
+        else if (opt == "-M" && arg + 1 < argc) num_procs = std::stoul(std::string(argv[++arg]));
+        else positional.push_back(opt);
+    }
+
+    // get source vertex from command arguments
+    uint64_t src_vertex = 0, num_iterations = 0;
+    if (argc <= 1 || (!server && positional.size() < 2)){
+        std::cout << "ERROR: missing required arguments!" << std::endl; 
+        std::cout << "USAGE: bin/exe path/to/graph src_vertex num_iterations\n       bin/exe path/to/graph -s|-S socket_path\nOptions:\n\t-U\tfor undirected graphs\n\t-d\tfor debugging\n\t-b\tfor binary result files\n\t-z\tfor compressed result files\n\t-G adj|csr|hybrid|grid|versioned|auto|auto+hybrid\tgraph data structure\n\t-t num_threads\tsize of the thread pool\n\t-p\tpin threads to CPUs\n\t-s\tserve queries on stdin\n\t-S socket_path\tserve queries on a Unix socket\n\t-o output_dir\tdirectory of the result files of the queries\n\t-F\tBFS with the frontier engine\n\t-X khop:k:s1,s2,...|sample:count\textract a subgraph\n\t-M num_procs\tBFS partitioned across processes\n\t-a scc|kcore|bc[:k|=s1,s2,...]|pr[:n|=epsilon]|louvain[=threshold]|anf[:b]\trun an analytics kernel" << std::endl; 
+        return 1;
+    } else if (!server) {
+        src_vertex = std::stoul(positional[0]);
+        num_iterations = std::stoul(positional[1]);
+    }
+
+    // thread pool shared by graph builders, kernels and result writer
+    ThreadPool::configure(num_threads, pin_threads);
+
+    // get memory usage before loading the graph
+    process_mem_usage(vm_usage, resident_set_size, false);
+
+    // read the edges in a compact staging list (undirected edges are stored once,
+    // the graph builders add both directions)
+    EdgeList edges;
+    if(debug) std::cout << "Loading the graph " << graphName << std::endl;
+    if (!edges.load(graphName, undirected))
+        return 1;
+    if(debug) std::cout << "Graph loaded!" << std::endl << std::endl;
+
+    // get increment in memory usage after loading the graph
+    process_mem_usage(vm_usage, resident_set_size, true);
+    if(debug) std::cout << "Edge list size: " << resident_set_size/1024 << " MB" << std::endl << std::endl;
+
+    // get number of nodes and directed edges
+    // (no self-loop allowed: each undirected edge = 2 directed edges);
+    // v is at least the largest id, in case ids have gaps (e.g. sampled subgraphs), so that
+    // the outputs (vertices 0..v) include it
+    uint64_t v = std::max(edges.vertices(), edges.max_vertex_id());
+    uint64_t e = edges.size();
+    
+    // print graph info
+    if(debug) print_graph_info(v, e, undirected);
+
+    // pick the data structure from the degree distribution, density and weights
+    // (auto+hybrid also allows HybridGraph, whose DFS order and sums differ)
+    if (graphType == "auto" || graphType == "auto+hybrid") {
+        GraphStats stats = compute_graph_stats(edges);
+        GraphChoice choice = select_graph_type(stats, graphType == "auto+hybrid");
+        graphType = choice.type;
+        if(debug) {
+            print_graph_stats(std::cout, stats);
+            print_graph_choice(std::cout, choice);
+        }
+    }
+
+    // results are written in background, while the next phase is running
+    ResultWriter writer(format);
+
+    // get memory usage before instantiating and populating the graph
+    process_mem_usage(vm_usage, resident_set_size, false);
+
+    if (num_procs > 0) {
+        int status = run_partitioned(graphName, src_vertex, num_iterations, debug, edges, v, num_procs, writer, vm_usage, resident_set_size);
+        writer.wait();
+        return status;
+    }
+
+    if (server) {
+        if (graphType == "versioned")
+            return run_server<VersionedGraph>(edges, v, e, format, socket_path, output_dir, debug);
+        if (graphType == "hybrid")
+            return run_server<HybridGraph>(edges, v, e, format, socket_path, output_dir, debug);
+        if (graphType == "grid")
+            return run_server<GridGraph>(edges, v, e, format, socket_path, output_dir, debug);
+        if (graphType == "csr")
+            return run_server<CSRGraph>(edges, v, e, format, socket_path, output_dir, debug);
+        return run_server<AdjacencyList>(edges, v, e, format, socket_path, output_dir, debug);
+    }
+    
+    if (graphType == "hybrid")
+        run_iterations<HybridGraph>(graphName, src_vertex, num_iterations, debug, edges, v, e, kernels, frontier_bfs, extract, writer, vm_usage, resident_set_size);
+    else if (graphType == "versioned")
+        run_iterations<VersionedGraph>(graphName, src_vertex, num_iterations, debug, edges, v, e, kernels, frontier_bfs, extract, writer, vm_usage, resident_set_size);
+    else if (graphType == "grid")
+        run_iterations<GridGraph>(graphName, src_vertex, num_iterations, debug, edges, v, e, kernels, frontier_bfs, extract, writer, vm_usage, resident_set_size);
+    else if (graphType == "csr")
+        run_iterations<CSRGraph>(graphName, src_vertex, num_iterations, debug, edges, v, e, kernels, frontier_bfs, extract, writer, vm_usage, resident_set_size);
+    else
+        run_iterations<AdjacencyList>(graphName, src_vertex, num_iterations, debug, edges, v, e, kernels, frontier_bfs, extract, writer, vm_usage, resident_set_size);
 
-    // free memory
-    delete[] edges;
+    writer.wait();
     
     return 0;
 }